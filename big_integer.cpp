@@ -1,9 +1,9 @@
 #include "big_integer.h"
+#include "limbs.h"
 
 #include <cstring>
-#include <cmath>
 #include <algorithm>
-#include <cctype>
+#include <functional>
 #include <stdexcept>
 
 
@@ -12,6 +12,11 @@ big_integer::big_integer() : sign(false), digits(2, 0) {
 
 big_integer::big_integer(big_integer const &other) = default;
 
+big_integer::big_integer(big_integer &&other) noexcept : sign(other.sign), digits(std::move(other.digits)) {
+    other.sign = false;
+    other.digits.assign(2, 0);
+}
+
 big_integer::big_integer(uint32_t a) : sign(false), digits(2) {
     digits[0] = a;
     digits[1] = 0;
@@ -21,33 +26,33 @@ big_integer::big_integer(int a) {
     digits.assign(2, 0);
     digits[0] = a;
     if (a < 0) {
-        digits[1] = UINT32_MAX;
+        digits[1] = LIMB_MAX;
         sign = true;
     }
 }
 
-big_integer::big_integer(std::string const &str) {
+namespace {
+    void check_base(unsigned base) {
+        if (base < 2 || base > limbs::MAX_BASE) {
+            throw std::runtime_error("Invalid_base");
+        }
+    }
+}
+
+big_integer::big_integer(std::string const &str, unsigned base) {
+    check_base(base);
     bool neg = false;
     if (str[0] == '-') {
         neg = true;
     }
     for (size_t i = neg; i < str.size(); i++) {
-        if (!isdigit(str[i])) {
+        if (limbs::digit_value(str[i], base) < 0) {
             throw std::runtime_error("Invalid_string");
         }
     }
-    digits.resize(2, 0);
-    for (size_t i = neg; i < str.size(); i += 9) {
-        uint32_t t = 0;
-        size_t j = 0;
-        for (; j < 9 && i + j < str.size(); j++) {
-            t *= 10;
-            t += str[i + j] - '0';
-        }
-        *this = *this * static_cast<int>(pow(10, j));
-        *this += t;
-    }
-    if (neg) *this = -*this;
+    my_vector mag(limbs::set_str_size(str.size() - neg, base), 0);
+    limbs::set_str(mag.data(), str.data() + neg, str.size() - neg, base);
+    set_magnitude(mag, neg);
 }
 
 //big_integer::~big_integer() {
@@ -61,24 +66,35 @@ big_integer &big_integer::operator=(big_integer const &other) {
     return *this;
 }
 
-template<class FunctorT>
-big_integer &big_integer::add(big_integer const &rhs, FunctorT f) {
-    size_t size = std::max(this->size(), rhs.size()) + 1;
-    uint32_t word = (rhs.sign ? f(UINT32_MAX) : f(0));
-    digits.resize(size, (sign ? UINT32_MAX : 0));
-    uint64_t tmp = 0;
-    bool carry = f(0);
-    for (size_t i = 0; i < rhs.size(); i++) {
-        uint32_t ri = f(rhs.digits[i]);
-        tmp = static_cast<uint64_t>(digits[i]) + ri + carry;
-        digits[i] = static_cast<uint32_t >(tmp);
-        carry = static_cast<bool>(tmp >> 32u);
-    }
-    for (size_t i = rhs.size(); i < size; i++) {
-        uint32_t li = digits[i];
-        tmp = static_cast<uint64_t>(li) + word + carry;
-        digits[i] = static_cast<uint32_t >(tmp);
-        carry = static_cast<bool>(tmp >> 32u);
+big_integer &big_integer::operator=(big_integer &&other) noexcept {
+    if (this == &other) return *this;
+    digits.swap(other.digits);
+    sign = other.sign;
+    other.sign = false;
+    other.digits.assign(2, 0);
+    return *this;
+}
+
+big_integer &big_integer::add(big_integer const &rhs, bool subtract) {
+    size_t const n = rhs.size(), size = std::max(this->size(), n) + 1;
+    digits.resize(size, (sign ? LIMB_MAX : 0));
+    limb_t *r = digits.data();
+    limb_t const *b = rhs.digits.data();
+    // past rhs its sign word of all ones counts as -1, which the carry (or borrow) may cancel
+    if (!subtract) {
+        limb_t carry = limbs::add_n(r, r, b, n);
+        if (!rhs.sign) {
+            limbs::add_1(r + n, r + n, size - n, carry);
+        } else if (carry == 0) {
+            limbs::sub_1(r + n, r + n, size - n, 1);
+        }
+    } else {
+        limb_t borrow = limbs::sub_n(r, r, b, n);
+        if (!rhs.sign) {
+            limbs::sub_1(r + n, r + n, size - n, borrow);
+        } else if (borrow == 0) {
+            limbs::add_1(r + n, r + n, size - n, 1);
+        }
     }
     sign = static_cast<bool>(digits.back());
     delete_leading_zeros();
@@ -87,92 +103,182 @@ big_integer &big_integer::add(big_integer const &rhs, FunctorT f) {
 
 
 big_integer &big_integer::operator+=(big_integer const &rhs) {
-    return add(rhs, element());
+    return add(rhs, false);
 }
 
 big_integer &big_integer::operator-=(big_integer const &rhs) {
-    return add(rhs, std::bit_not<>());
+    return add(rhs, true);
 }
 
 
 big_integer &big_integer::operator*=(big_integer const &rhs) {
-    bool neg = sign ^rhs.sign;
-    big_integer left = abs(*this), right = abs(rhs);
-    digits.assign(size() + right.size(), 0);
-    sign = 0;
-    for (size_t i = 0; i < left.size(); i++) {
-        uint64_t carry = 0;
-        for (size_t j = 0; j < right.size(); j++) {
-            uint64_t tmp = static_cast<uint64_t>(left.digits[i]) * right.digits[j];
-            tmp += digits[i + j] + carry;
-            digits[i + j] = static_cast<uint32_t >(tmp);
-            carry = static_cast<uint32_t >(tmp >> 32u);
+    mul_value(*this, rhs);
+    return *this;
+}
+
+// this = a in the limbs this already owns, ready to be updated in place
+void big_integer::copy_value(big_integer const &a) {
+    if (this == &a) return;
+    digits.reset(a.size());
+    std::copy_n(a.digits.data(), a.size(), digits.data());
+    sign = a.sign;
+}
+
+// this = a * b, where this may be a or b; the product goes into the limbs of this unless they are shared
+void big_integer::mul_value(big_integer const &a, big_integer const &b) {
+    bool const same = a.shares_digits(b), neg = a.sign ^ b.sign;
+    size_t ln, rn = 0;
+    my_vector const left = a.magnitude(ln), right = (same ? left : b.magnitude(rn));
+    if (same) rn = ln;
+    my_vector res(std::move(digits));
+    if (ln == 0 || rn == 0) {
+        res.assign(2, 0);
+    } else {
+        res.reset(ln + rn + 1);
+        limb_t *p = res.data();
+        p[ln + rn] = 0;
+        if (same) {
+            limbs::sqr(p, left.data(), ln);
+        } else if (ln >= rn) {
+            limbs::mul(p, left.data(), ln, right.data(), rn);
+        } else {
+            limbs::mul(p, right.data(), rn, left.data(), ln);
         }
-        digits[i + right.size()] = static_cast<uint32_t>(carry);
     }
-    delete_leading_zeros();
-    if (neg) *this = -*this;
+    set_magnitude(res, neg);
+}
+
+big_integer &big_integer::mul_small(uint32_t b, bool neg) {
+    size_t n;
+    my_vector const mag = magnitude(n);
+    my_vector res(n + 1, 0);
+    res[n] = limbs::mul_1(res.data(), mag.data(), n, b);
+    set_magnitude(res, neg);
     return *this;
 }
 
-big_integer &big_integer::sub_from(big_integer const &rhs, int pos) {
-    uint32_t word = (!rhs.sign ? UINT32_MAX : 0);
-    uint64_t tmp = 0;
-    char carry = 1;
-    digits.resize(std::max(rhs.size() + pos, size()), 0 - sign);
-    for (size_t i = 0; i < rhs.size(); i++) {
-        tmp = static_cast<uint64_t>(digits[i + pos]) + ~rhs.digits[i] + carry;
-        digits[i + pos] = static_cast<uint32_t >(tmp);
-        carry = static_cast<bool>(tmp >> 32u);
+big_integer &big_integer::operator*=(uint32_t rhs) {
+    return mul_small(rhs, sign);
+}
+
+big_integer &big_integer::operator*=(int rhs) {
+    uint32_t m = (rhs < 0 ? 0u - static_cast<uint32_t>(rhs) : static_cast<uint32_t>(rhs));
+    return mul_small(m, sign ^ (rhs < 0));
+}
+
+namespace {
+    // smaller factor from which addmul forms the product instead of adding it row by row
+    size_t const ADDMUL_THRESHOLD = 96;
+
+    // r[0, n) += a * b, or -= when subtract, for n > an; like two's complement it wraps at the top
+    void addmul_row(limb_t *r, size_t n, limb_t const *a, size_t an, limb_t b, bool subtract) {
+        if (subtract) {
+            limbs::sub_1(r + an, r + an, n - an, limbs::submul_1(r, a, an, b));
+        } else {
+            limbs::add_1(r + an, r + an, n - an, limbs::addmul_1(r, a, an, b));
+        }
+    }
+}
+
+// this += a * b, or -= when subtract. The rows of |a| * |b| go straight into the two's complement limbs,
+// which is exact once there is room for the result; for large factors a product temporary is cheaper
+big_integer &big_integer::addmul_value(big_integer const &a, big_integer const &b, bool subtract) {
+    bool const neg = subtract ^ a.sign ^ b.sign;
+    size_t an, bn;
+    my_vector const u = a.magnitude(an), v = b.magnitude(bn);
+    limb_t const *up = u.data(), *vp = v.data();
+    if (an < bn) {
+        std::swap(up, vp);
+        std::swap(an, bn);
+    }
+    if (bn == 0) {
+        return *this;
+    }
+    if (bn >= ADDMUL_THRESHOLD) {
+        big_integer p;
+        p.mul_value(a, b);
+        return add(p, subtract);
     }
-    for (size_t i = rhs.size() + pos; i < size(); i++) {
-        uint32_t li = digits[i];
-        tmp = static_cast<uint64_t>(li) + word + carry;
-        digits[i] = static_cast<uint32_t >(tmp);
-        carry = static_cast<bool>(tmp >> 32u);
+    size_t const n = std::max(size(), an + bn) + 1;
+    digits.resize(n, (sign ? LIMB_MAX : 0));
+    limb_t *r = digits.data();
+    for (size_t j = 0; j < bn; j++) {
+        addmul_row(r + j, n - j, up, an, vp[j], neg);
     }
     sign = static_cast<bool>(digits.back());
     delete_leading_zeros();
     return *this;
 }
 
-big_integer big_integer::divide2n1n(big_integer &rhs) {
-    big_integer left = *this;
-    size_t r = rhs.size() - 1, l = size();
-    uint32_t d = UINT32_MAX / (rhs.digits[r - 1] + 1);
-    left *= d;
-    rhs *= d;
-    uint32_t b = rhs.digits[r - 1];
-    l--;
-    digits.resize(l - r + 1);
-    for (int j = l - r; j > -1; j--) {
-        uint64_t a = ((static_cast<uint64_t> (left.get_digit(j + r)) << 32u) + left.get_digit(j + r - 1));
-        uint64_t qi = std::min(a / b, static_cast<uint64_t> (UINT32_MAX));
-        uint64_t ri = a % b;
-        while (ri < UINT32_MAX && qi * rhs.get_digit(r - 2) > (ri << 32u) + left.get_digit(j + r - 2)) {
-            qi--;
-            ri += b;
-        }
-        left.sub_from(rhs * qi, j);
-        digits[j] = static_cast<uint32_t >(qi);
+big_integer &big_integer::addmul_small(big_integer const &a, uint32_t b, bool subtract) {
+    bool const neg = subtract ^ a.sign;
+    size_t an;
+    my_vector const u = a.magnitude(an);
+    if (an == 0 || b == 0) {
+        return *this;
     }
+    size_t const n = std::max(size(), an + 1) + 1;
+    digits.resize(n, (sign ? LIMB_MAX : 0));
+    addmul_row(digits.data(), n, u.data(), an, b, neg);
+    sign = static_cast<bool>(digits.back());
     delete_leading_zeros();
     return *this;
 }
 
+void add(big_integer &r, big_integer const &a, big_integer const &b) {
+    r = a + b;
+}
+
+void sub(big_integer &r, big_integer const &a, big_integer const &b) {
+    r = a - b;
+}
+
+void mul(big_integer &r, big_integer const &a, big_integer const &b) {
+    r = a * b;
+}
+
+void addmul(big_integer &acc, big_integer const &a, big_integer const &b) {
+    acc.addmul_value(a, b, false);
+}
+
+void submul(big_integer &acc, big_integer const &a, big_integer const &b) {
+    acc.addmul_value(a, b, true);
+}
+
+void addmul(big_integer &acc, big_integer const &a, uint32_t b) {
+    acc.addmul_small(a, b, false);
+}
+
+void submul(big_integer &acc, big_integer const &a, uint32_t b) {
+    acc.addmul_small(a, b, true);
+}
+
+void addmul(big_integer &acc, big_integer const &a, int b) {
+    acc.addmul_small(a, (b < 0 ? 0u - static_cast<uint32_t>(b) : static_cast<uint32_t>(b)), b < 0);
+}
+
+void submul(big_integer &acc, big_integer const &a, int b) {
+    acc.addmul_small(a, (b < 0 ? 0u - static_cast<uint32_t>(b) : static_cast<uint32_t>(b)), b >= 0);
+}
+
+big_integer square(big_integer const &a) {
+    big_integer r;
+    r.mul_value(a, a);
+    return r;
+}
+
+limbs::mul_tier mul_tier_for(big_integer const &a, big_integer const &b) {
+    size_t an, bn;
+    a.magnitude(an);
+    if (a.shares_digits(b))
+        return limbs::sqr_tier_for(an);
+    b.magnitude(bn);
+    return limbs::mul_tier_for(an, bn);
+}
+
 big_integer &big_integer::operator/=(big_integer const &rhs) {
-    bool neg = sign ^rhs.sign;
-    big_integer right = abs(rhs);
-    *this = abs(*this);
-    if (rhs.is_zero()) {
-        throw std::runtime_error("Division by zero");
-    }
-    if (*this < right) {
-        *this = 0;
-        return *this;
-    }
-    divide2n1n(right);
-    if (neg) *this = -*this;
+    big_integer r;
+    tdiv_qr(*this, r, *this, rhs);
     return *this;
 }
 
@@ -180,13 +286,133 @@ big_integer &big_integer::operator%=(big_integer const &rhs) {
     if (rhs.is_zero()) {
         throw std::runtime_error("Module of zero");
     }
-    return *this -= (*this / rhs) * rhs;
+    big_integer q;
+    tdiv_qr(q, *this, *this, rhs);
+    return *this;
+}
+
+void tdiv_qr(big_integer &q, big_integer &r, big_integer const &n, big_integer const &d) {
+    if (d.is_zero()) {
+        throw std::runtime_error("Division by zero");
+    }
+    bool const q_neg = n.sign ^ d.sign, r_neg = n.sign;
+    size_t an, bn;
+    // the magnitudes keep the operands readable while q and r, which may be them, are overwritten
+    my_vector const u = n.magnitude(an), v = d.magnitude(bn);
+    if (an < bn) {
+        r.copy_value(n);
+        q.sign = false;
+        q.digits.assign(2, 0);
+        return;
+    }
+    my_vector qm(std::move(q.digits)), rm(std::move(r.digits));
+    qm.reset(an - bn + 1);
+    rm.reset(bn);
+    limbs::divrem(qm.data(), rm.data(), u.data(), an, v.data(), bn);
+    q.set_magnitude(qm, q_neg);
+    r.set_magnitude(rm, r_neg);
+}
+
+std::pair<big_integer, big_integer> divmod(big_integer const &a, big_integer const &b, rounding mode) {
+    big_integer q, r;
+    tdiv_qr(q, r, a, b);
+    // step the truncated quotient down (or up for the Euclidean one with b < 0) when the remainder has the wrong sign
+    bool adjust = (mode == rounding::floor ? r.sign != b.sign : mode == rounding::euclid && r.sign);
+    if (adjust && !r.is_zero()) {
+        if (mode == rounding::euclid && b.sign) {
+            ++q;
+            r -= b;
+        } else {
+            --q;
+            r += b;
+        }
+    }
+    return {std::move(q), std::move(r)};
+}
+
+big_integer &big_integer::operator/=(uint32_t rhs) {
+    return *this = divmod(*this, rhs).first;
+}
+
+big_integer &big_integer::operator/=(int rhs) {
+    return *this = divmod(*this, rhs).first;
+}
+
+big_integer &big_integer::operator%=(uint32_t rhs) {
+    return *this = divmod(*this, rhs).second;
+}
+
+big_integer &big_integer::operator%=(int rhs) {
+    return *this = divmod(*this, rhs).second;
+}
+
+std::pair<big_integer, big_integer> divmod(big_integer const &a, uint32_t b) {
+    return divmod(a, static_cast<uint64_t>(b));
+}
+
+std::pair<big_integer, big_integer> divmod(big_integer const &a, uint64_t b) {
+    if (b == 0) {
+        throw std::runtime_error("Division by zero");
+    }
+    size_t n;
+    my_vector const mag = a.magnitude(n);
+    big_integer quotient, remainder;
+    if (b <= LIMB_MAX) {
+        my_vector q(n + 1, 0), r(2, 0);
+        r[0] = limbs::divrem_1(q.data(), mag.data(), n, static_cast<limb_t>(b));
+        quotient.set_magnitude(q, a.sign);
+        remainder.set_magnitude(r, a.sign);
+        return {std::move(quotient), std::move(remainder)};
+    }
+    // two limbs, only with 32-bit limbs
+    if (n < 2) {
+        return {big_integer(), a};
+    }
+    limb_t const d[2] = {static_cast<limb_t>(b), static_cast<limb_t>(b >> 32u)};
+    my_vector q(n - 1), r(2);
+    limbs::divrem(q.data(), r.data(), mag.data(), n, d, 2);
+    quotient.set_magnitude(q, a.sign);
+    remainder.set_magnitude(r, a.sign);
+    return {std::move(quotient), std::move(remainder)};
+}
+
+std::pair<big_integer, big_integer> divmod(big_integer const &a, int b) {
+    std::pair<big_integer, big_integer> res = divmod(a, (b < 0 ? 0u - static_cast<uint32_t>(b) : static_cast<uint32_t>(b)));
+    if (b < 0) res.first = -res.first;
+    return res;
+}
+
+namespace {
+    void bitwise_n(std::bit_and<>, limb_t *r, limb_t const *a, limb_t const *b, size_t n) {
+        limbs::and_n(r, a, b, n);
+    }
+
+    void bitwise_n(std::bit_or<>, limb_t *r, limb_t const *a, limb_t const *b, size_t n) {
+        limbs::ior_n(r, a, b, n);
+    }
+
+    void bitwise_n(std::bit_xor<>, limb_t *r, limb_t const *a, limb_t const *b, size_t n) {
+        limbs::xor_n(r, a, b, n);
+    }
 }
 
 template<class FunctorT>
 big_integer &big_integer::bitwise_operation(big_integer const &rhs, FunctorT functor) {
-    for (size_t i = 0; i < size(); i++) {
-        digits[i] = functor(digits[i], rhs.get_digit(i));
+    size_t const n = rhs.size();
+    if (size() < n) {
+        digits.resize(n, (sign ? LIMB_MAX : 0));
+    }
+    limb_t *r = digits.data();
+    bitwise_n(functor, r, r, rhs.digits.data(), n);
+    // past rhs every limb meets its sign word, which keeps, complements or overwrites it
+    limb_t const word = (rhs.sign ? LIMB_MAX : 0);
+    limb_t const from_zero = functor(static_cast<limb_t>(0), word);
+    if (from_zero != functor(LIMB_MAX, word)) {
+        if (from_zero != 0) {
+            limbs::com(r + n, r + n, size() - n);
+        }
+    } else {
+        std::fill(r + n, r + size(), from_zero);
     }
     sign = static_cast<bool>(digits.back());
     delete_leading_zeros();
@@ -206,7 +432,7 @@ big_integer &big_integer::operator^=(big_integer const &rhs) {
 }
 
 void big_integer::delete_leading_zeros() {
-    uint32_t word = (sign ? UINT32_MAX : 0);
+    limb_t word = (sign ? LIMB_MAX : 0);
     if (digits.back() != word) {
         digits.push_back(word);
         return;
@@ -218,35 +444,68 @@ void big_integer::delete_leading_zeros() {
     digits.resize(true_size);
 }
 
-big_integer &big_integer::operator<<=(int rhs) {
-    if (rhs < 0) return *this >>= (-rhs);
-    uint32_t prev = rhs / 32, step = rhs % 32;
-    size_t size = this->size() + prev + 1;
-    digits.resize(size, sign ? UINT32_MAX : 0);
-    for (size_t i = size - 1; i > prev; i--) {
-        digits[i] = (digits[i - prev] << step) |
-                    static_cast<uint32_t >(static_cast<uint64_t > (digits[i - prev - 1]) >> (32 - step));
+// true when both numbers are backed by the same limbs, so they are equal
+bool big_integer::shares_digits(big_integer const &other) const {
+    return size() == other.size() && digits.data() == other.digits.data();
+}
+
+my_vector big_integer::magnitude(size_t &n) const {
+    if (!sign) {
+        n = limbs::normalized_size(digits.data(), size());
+        return digits;
     }
-    digits[prev] = digits[0] << step;
-    for (size_t i = 0; i < prev; i++) {
-        digits[i] = 0;
+    my_vector res(size());
+    limb_t *p = res.data();
+    limb_t const *d = digits.data();
+    for (size_t i = 0; i < size(); i++)
+        p[i] = ~d[i];
+    limbs::add_1(p, p, size(), 1);
+    n = limbs::normalized_size(p, size());
+    return res;
+}
+
+void big_integer::set_magnitude(my_vector &mag, bool neg) {
+    size_t n = limbs::normalized_size(mag.data(), mag.size());
+    mag.resize(std::max(n + 1, static_cast<size_t>(2)));
+    if (neg) {
+        limb_t *p = mag.data();
+        for (size_t i = 0; i < mag.size(); i++)
+            p[i] = ~p[i];
+        limbs::add_1(p, p, mag.size(), 1);
     }
+    digits.swap(mag);
     sign = static_cast<bool>(digits.back());
     delete_leading_zeros();
+}
+
+big_integer &big_integer::operator<<=(int rhs) {
+    if (rhs < 0) return *this >>= (-rhs);
+    size_t const prev = rhs / LIMB_BITS, n = size();
+    unsigned const step = rhs % LIMB_BITS;
+    digits.resize(n + prev + 1);
+    limb_t *r = digits.data();
+    // the top limb is the sign word, so the bits shifted out of it only extend the sign
+    limb_t const out = limbs::lshift(r + prev, r, n, step);
+    r[n + prev] = out | (sign ? LIMB_MAX << step : 0);
+    std::fill(r, r + prev, 0);
+    delete_leading_zeros();
     return *this;
 }
 
 big_integer &big_integer::operator>>=(int rhs) {
     if (rhs < 0) return *this <<= (-rhs);
-    uint32_t prev = rhs / 32, step = rhs % 32;
-    size_t size = std::max(this->size() - prev, static_cast<size_t>(2));
-    for (size_t i = 0; i < size; i++) {
-        digits[i] =
-                (get_digit(i + prev + 1) << (32 - step)) | (digits[i + prev] >> step);
-    }
-    digits.resize(size);
-    if (size == 0) digits.push_back(0);
-    sign = static_cast<bool>(digits.back());
+    size_t const prev = rhs / LIMB_BITS, n = size();
+    unsigned const step = rhs % LIMB_BITS;
+    if (prev + 1 >= n) {
+        digits.assign(2, (sign ? LIMB_MAX : 0));
+        return *this;
+    }
+    limb_t *r = digits.data();
+    limbs::rshift(r, r + prev, n - prev, step);
+    if (sign) {
+        r[n - prev - 1] |= ~(LIMB_MAX >> step);
+    }
+    digits.resize(n - prev);
     delete_leading_zeros();
     return *this;
 }
@@ -255,24 +514,34 @@ big_integer big_integer::operator+() const {
     return *this;
 }
 
-big_integer big_integer::operator-() const {
+big_integer big_integer::operator-() const & {
     return ~*this + 1;
 }
 
+big_integer big_integer::operator-() && {
+    return ~std::move(*this) + 1;
+}
+
 size_t big_integer::size() const {
     return digits.size();
 }
 
 
-big_integer big_integer::operator~() const {
+big_integer big_integer::operator~() const & {
     big_integer r;
     r.digits.resize(size());
-    for (size_t i = 0; i < r.size(); i++)
-        r.digits[i] = ~digits[i];
+    limbs::com(r.digits.data(), digits.data(), size());
     r.sign = !sign;
     return r;
 }
 
+big_integer big_integer::operator~() && {
+    limb_t *p = digits.data();
+    limbs::com(p, p, size());
+    sign = !sign;
+    return std::move(*this);
+}
+
 big_integer &big_integer::operator++() {
     *this += 1;
     return *this;
@@ -295,68 +564,136 @@ big_integer big_integer::operator--(int) {
     return r;
 }
 
-uint32_t big_integer::get_digit(size_t i) const {
-    if (size() <= i) {
-        return (sign ? UINT32_MAX : 0);
-    } else return digits[i];
+
+big_integer operator+(big_integer &&a, big_integer const &b) {
+    a += b;
+    return std::move(a);
+}
+
+big_integer operator+(big_integer &&a, big_integer &&b) {
+    a += b;
+    return std::move(a);
 }
 
+big_integer operator-(big_integer &&a, big_integer const &b) {
+    a -= b;
+    return std::move(a);
+}
 
-big_integer operator+(big_integer a, big_integer const &b) {
-    return a += b;
+big_integer operator-(big_integer &&a, big_integer &&b) {
+    a -= b;
+    return std::move(a);
 }
 
+big_integer operator*(big_integer &&a, big_integer const &b) {
+    a *= b;
+    return std::move(a);
+}
 
-big_integer operator-(big_integer a, big_integer const &b) {
-    return a -= b;
+big_integer operator*(big_integer const &a, big_integer &&b) {
+    b *= a;
+    return std::move(b);
 }
 
-big_integer operator*(big_integer a, big_integer const &b) {
-    return a *= b;
+big_integer operator*(big_integer &&a, big_integer &&b) {
+    a *= b;
+    return std::move(a);
 }
 
 big_integer operator*(big_integer a, uint32_t const &b) {
-    bool neg = false;
-    if (a.sign) {
-        neg = true;
-        a = -a;
-    }
-    uint32_t carry = 0;
-    for (size_t i = 0; i < a.size(); i++) {
-        uint64_t tmp = static_cast<uint64_t> (b) * a.digits[i] + carry;
-        a.digits[i] = (uint32_t) tmp;
-        carry = static_cast<uint32_t >(tmp >> 32u);
-    }
-    if (neg) a = -a;
+    a *= b;
+    return a;
+}
+
+big_integer operator*(big_integer a, int b) {
+    a *= b;
     return a;
 }
 
+big_integer operator+(big_integer const &a, big_integer &&b) {
+    b += a;
+    return std::move(b);
+}
+
+big_integer operator-(big_integer const &a, big_integer &&b) {
+    b -= a;
+    return -std::move(b);
+}
+
 big_integer operator/(big_integer a, big_integer const &b) {
-    return a /= b;
+    a /= b;
+    return a;
 }
 
-big_integer operator%(big_integer a, big_integer const &b) {
-    return a %= b;
+big_integer operator%(big_integer &&a, big_integer const &b) {
+    a %= b;
+    return std::move(a);
+}
+
+big_integer operator%(big_integer const &a, big_integer &&b) {
+    b = a % b;
+    return std::move(b);
+}
+
+big_integer operator%(big_integer &&a, big_integer &&b) {
+    a %= b;
+    return std::move(a);
+}
+
+big_integer operator/(big_integer const &a, uint32_t b) {
+    return divmod(a, b).first;
+}
+
+big_integer operator/(big_integer const &a, int b) {
+    return divmod(a, b).first;
+}
+
+big_integer operator%(big_integer a, uint32_t b) {
+    return divmod(a, b).second;
+}
+
+big_integer operator%(big_integer a, int b) {
+    return divmod(a, b).second;
 }
 
 big_integer operator&(big_integer a, big_integer const &b) {
-    return a &= b;
+    a &= b;
+    return a;
 }
 
 big_integer operator|(big_integer a, big_integer const &b) {
-    return a |= b;
+    a |= b;
+    return a;
 }
 
 big_integer operator^(big_integer a, big_integer const &b) {
-    return a ^= b;
+    a ^= b;
+    return a;
+}
+
+big_integer operator&(big_integer const &a, big_integer &&b) {
+    b &= a;
+    return std::move(b);
+}
+
+big_integer operator|(big_integer const &a, big_integer &&b) {
+    b |= a;
+    return std::move(b);
+}
+
+big_integer operator^(big_integer const &a, big_integer &&b) {
+    b ^= a;
+    return std::move(b);
 }
 
 big_integer operator<<(big_integer a, int b) {
-    return a <<= b;
+    a <<= b;
+    return a;
 }
 
 big_integer operator>>(big_integer a, int b) {
-    return a >>= b;
+    a >>= b;
+    return a;
 }
 
 bool big_integer::is_zero() const {
@@ -369,15 +706,63 @@ bool big_integer::is_zero() const {
     return true;
 }
 
-int big_integer::cmp(big_integer const &b) const {
-    if (b.is_zero()) {
-        if (is_zero())
-            return 0;
+// b[0, bn) is normalized like digits: sign word on top, and the limb below it differs unless bn == 2
+int big_integer::cmp(limb_t const *b, size_t bn) const {
+    bool b_sign = b[bn - 1] != 0;
+    if (sign != b_sign) {
         return (sign ? -1 : 1);
     }
-    big_integer tmp = *this - b;
-    if (tmp.is_zero()) return 0;
-    return (tmp.sign ? -1 : 1);
+    if (size() != bn) {
+        return ((size() > bn) != sign ? 1 : -1);
+    }
+    limb_t const *a = digits.data();
+    for (size_t i = bn; i-- > 0;) {
+        if (a[i] != b[i]) {
+            return (a[i] < b[i] ? -1 : 1);
+        }
+    }
+    return 0;
+}
+
+int big_integer::cmp(big_integer const &b) const {
+    return cmp(b.digits.data(), b.size());
+}
+
+int compare(big_integer const &a, big_integer const &b) {
+    return a.cmp(b);
+}
+
+namespace {
+    // v as normalized limbs with the sign word on top, returns their count
+    size_t native_limbs(limb_t *w, uint64_t v, bool neg) {
+        limb_t const word = (neg ? LIMB_MAX : 0);
+        size_t n = 0;
+        for (unsigned shift = 0; shift < 64; shift += LIMB_BITS)
+            w[n++] = static_cast<limb_t>(v >> shift);
+        w[n++] = word;
+        while (n > 2 && w[n - 2] == word)
+            n--;
+        return n;
+    }
+}
+
+int compare(big_integer const &a, int64_t b) {
+    limb_t w[64 / LIMB_BITS + 1];
+    return a.cmp(w, native_limbs(w, static_cast<uint64_t>(b), b < 0));
+}
+
+int compare(big_integer const &a, uint64_t b) {
+    limb_t w[64 / LIMB_BITS + 1];
+    return a.cmp(w, native_limbs(w, b, false));
+}
+
+void big_integer::set_native(uint64_t v, bool is_signed) {
+    bool const neg = is_signed && static_cast<int64_t>(v) < 0;
+    limb_t w[64 / LIMB_BITS + 1];
+    size_t const n = native_limbs(w, v, neg);
+    digits.reset(n);
+    std::copy_n(w, n, digits.data());
+    sign = neg;
 }
 
 big_integer abs(big_integer const &a) {
@@ -408,29 +793,20 @@ bool operator>=(big_integer const &a, big_integer const &b) {
     return !(a < b);
 }
 
-std::string to_string(big_integer const &a) {
-    std::string res;
-    big_integer tmp = a;
-    bool sign = false;
-    if (tmp.sign) {
-        sign = true;
-        tmp = -tmp;
-    }
-    while (!tmp.is_zero()) {
-        uint32_t c = (tmp % int(1e9)).digits[0];
-        tmp /= int(1e9);
-        bool b = tmp.is_zero();
-        for (int i = 0; i < 9; i++) {
-            res = char(c % 10 + int('0')) + res;
-            c /= 10;
-            if (b && c == 0) break;
-        }
-    }
-    if (res.empty()) return "0";
-    if (sign) res = '-' + res;
+std::string to_string(big_integer const &a, unsigned base) {
+    check_base(base);
+    size_t n;
+    my_vector const mag = a.magnitude(n);
+    std::string res(limbs::get_str_size(n, base) + 1, '-');
+    size_t len = limbs::get_str(&res[a.sign], mag.data(), n, base);
+    res.resize(len + a.sign);
     return res;
 }
 
+big_integer from_string(std::string const &str, unsigned base) {
+    return big_integer(str, base);
+}
+
 std::ostream &operator<<(std::ostream &s, big_integer const &a) {
     return s << to_string(a);
 }
@@ -3,25 +3,76 @@
 
 #include <cstddef>
 #include "my_vector.h"
+#include "limbs.h"
 #include <iosfwd>
 #include <cstdint>
 #include <vector>
+#include <utility>
+#include <type_traits>
+
+// how divmod rounds the quotient: toward zero (like operator/), toward negative infinity,
+// or so that the remainder is never negative
+enum class rounding {
+    truncate, floor, euclid
+};
+
+enum class expr_op {
+    add, sub, mul, rem
+};
+
+template<expr_op Op, class L, class R>
+struct big_integer_expr;
+
+// native integers that promote to neither int nor uint32_t, such as long and long long: converting them to either
+// is equally good, so they get overloads of their own
+template<class T, bool = std::is_integral<T>::value>
+struct is_wide_integral : std::false_type {
+};
+
+template<class T>
+struct is_wide_integral<T, true>
+        : std::integral_constant<bool, !std::is_same<std::common_type_t<T, int>, int>::value &&
+                                       !std::is_same<std::common_type_t<T, int>, uint32_t>::value> {
+};
 
 struct big_integer {
     big_integer();
 
     big_integer(big_integer const &other);
 
+    // leaves other equal to zero
+    big_integer(big_integer &&other) noexcept;
+
     big_integer(uint32_t a);
 
     big_integer(int a);
 
-    explicit big_integer(std::string const &str);
+    template<class T, class = std::enable_if_t<is_wide_integral<T>::value>>
+    big_integer(T a) : big_integer() {
+        set_native(static_cast<uint64_t>(a), std::is_signed<T>::value);
+    }
+
+    // digits in any base from 2 to 62 (see limbs::digit_value), with an optional leading '-'
+    explicit big_integer(std::string const &str, unsigned base = 10);
+
+    template<expr_op Op, class L, class R>
+    big_integer(big_integer_expr<Op, L, R> const &e) : big_integer() {
+        e.eval(*this);
+    }
 
 //    ~big_integer();
 
     big_integer &operator=(big_integer const &other);
 
+    big_integer &operator=(big_integer &&other) noexcept;
+
+    // computes e straight into the limbs of this
+    template<expr_op Op, class L, class R>
+    big_integer &operator=(big_integer_expr<Op, L, R> const &e) {
+        e.eval(*this);
+        return *this;
+    }
+
     big_integer &operator+=(big_integer const &rhs);
 
     big_integer &operator-=(big_integer const &rhs);
@@ -32,6 +83,18 @@ struct big_integer {
 
     big_integer &operator%=(big_integer const &rhs);
 
+    big_integer &operator*=(uint32_t rhs);
+
+    big_integer &operator*=(int rhs);
+
+    big_integer &operator/=(uint32_t rhs);
+
+    big_integer &operator/=(int rhs);
+
+    big_integer &operator%=(uint32_t rhs);
+
+    big_integer &operator%=(int rhs);
+
     big_integer &operator&=(big_integer const &rhs);
 
     big_integer &operator|=(big_integer const &rhs);
@@ -42,11 +105,28 @@ struct big_integer {
 
     big_integer &operator>>=(int rhs);
 
+    // acc += a * b and acc -= a * b add the product row by row instead of forming it
+    template<expr_op Op, class L, class R>
+    big_integer &operator+=(big_integer_expr<Op, L, R> const &e) {
+        e.add_to(*this, false);
+        return *this;
+    }
+
+    template<expr_op Op, class L, class R>
+    big_integer &operator-=(big_integer_expr<Op, L, R> const &e) {
+        e.add_to(*this, true);
+        return *this;
+    }
+
     big_integer operator+() const;
 
-    big_integer operator-() const;
+    big_integer operator-() const &;
+
+    big_integer operator-() &&;
+
+    big_integer operator~() const &;
 
-    big_integer operator~() const;
+    big_integer operator~() &&;
 
     big_integer &operator++();
 
@@ -56,6 +136,12 @@ struct big_integer {
 
     big_integer operator--(int);
 
+    friend int compare(big_integer const &a, big_integer const &b);
+
+    friend int compare(big_integer const &a, int64_t b);
+
+    friend int compare(big_integer const &a, uint64_t b);
+
     friend bool operator==(big_integer const &a, big_integer const &b);
 
     friend bool operator!=(big_integer const &a, big_integer const &b);
@@ -70,31 +156,62 @@ struct big_integer {
 
     friend big_integer operator*(big_integer a, uint32_t const &b);
 
-    friend std::string to_string(big_integer const &a);
+    friend std::string to_string(big_integer const &a, unsigned base);
 
-    friend
-    big_integer operator*(big_integer a, uint32_t const &b);
+    friend big_integer square(big_integer const &a);
+
+    friend limbs::mul_tier mul_tier_for(big_integer const &a, big_integer const &b);
+
+    friend std::pair<big_integer, big_integer> divmod(big_integer const &a, big_integer const &b, rounding mode);
+
+    friend void tdiv_qr(big_integer &q, big_integer &r, big_integer const &n, big_integer const &d);
+
+    friend std::pair<big_integer, big_integer> divmod(big_integer const &a, uint32_t b);
+
+    friend std::pair<big_integer, big_integer> divmod(big_integer const &a, uint64_t b);
+
+    friend void addmul(big_integer &acc, big_integer const &a, big_integer const &b);
+
+    friend void submul(big_integer &acc, big_integer const &a, big_integer const &b);
+
+    friend void addmul(big_integer &acc, big_integer const &a, uint32_t b);
+
+    friend void submul(big_integer &acc, big_integer const &a, uint32_t b);
+
+    friend void addmul(big_integer &acc, big_integer const &a, int b);
+
+    friend void submul(big_integer &acc, big_integer const &a, int b);
 
 private:
+    template<expr_op Op, class L, class R>
+    friend struct big_integer_expr;
 
-    struct element {
-        unsigned operator()(const unsigned &x) const {
-            return x;
-        }
-    };
+    void copy_value(big_integer const &a);
+
+    // the 64-bit value v, read as two's complement when is_signed
+    void set_native(uint64_t v, bool is_signed);
+
+    void mul_value(big_integer const &a, big_integer const &b);
 
     template<class FunctorT>
     big_integer &bitwise_operation(big_integer const &rhs, FunctorT functor);
 
-    template<class FunctorT>
-    big_integer &add(big_integer const &rhs, FunctorT f);
+    big_integer &add(big_integer const &rhs, bool subtract);
+
+    big_integer &mul_small(uint32_t b, bool neg);
 
-    big_integer &sub_from(big_integer const &rhs, int pos);
+    big_integer &addmul_value(big_integer const &a, big_integer const &b, bool subtract);
 
-    big_integer divide2n1n(big_integer &rhs);
+    big_integer &addmul_small(big_integer const &a, uint32_t b, bool subtract);
 
     void delete_leading_zeros();
 
+    bool shares_digits(big_integer const &other) const;
+
+    my_vector magnitude(size_t &n) const;
+
+    void set_magnitude(my_vector &mag, bool neg);
+
     bool is_zero() const;
 
     bool sign = false;
@@ -102,25 +219,264 @@ private:
 
     int cmp(big_integer const &b) const;
 
-    uint32_t get_digit(size_t i) const;
+    int cmp(limb_t const *b, size_t bn) const;
 
     size_t size() const;
 };
 
 
+// a big_integer operand is a named number and is referred to; a nested node is held by value
+template<class T>
+struct expr_operand {
+    typedef T type;
+};
+
+template<>
+struct expr_operand<big_integer> {
+    typedef big_integer const &type;
+};
+
+// a + b, a - b, a * b and a % b over big_integer lvalues or other nodes are not computed on the spot: the operators
+// return this node, and the big_integer it is assigned to or converted into evaluates the whole tree in its own
+// limbs. So r = a * b + c, r = (a + b) - c and r = a * b % m build no intermediate numbers. A temporary big_integer
+// never enters a node, the && overloads below compute with it at once. The node still refers to the named numbers
+// it was built from, so a function or lambda over its own locals or by-value parameters must return big_integer
+// rather than auto, and a node kept in an auto variable must not outlive its operands.
+template<expr_op Op, class L, class R>
+struct big_integer_expr {
+    typename expr_operand<L>::type l;
+    typename expr_operand<R>::type r;
+
+    big_integer operator-() const {
+        return -big_integer(*this);
+    }
+
+    big_integer operator~() const {
+        return ~big_integer(*this);
+    }
+
+    bool refers_to(big_integer const &x) const {
+        return refers(l, x) || refers(r, x);
+    }
+
+    // to += node, or to -= node when subtract
+    void add_to(big_integer &to, bool subtract) const {
+        big_integer tl, tr;
+        if (Op == expr_op::mul) {
+            to.addmul_value(value(l, tl), value(r, tr), subtract);
+        } else {
+            to.add(big_integer(*this), subtract);
+        }
+    }
+
+    void eval(big_integer &to) const {
+        big_integer tl, tr;
+        if (Op == expr_op::mul) {
+            // both factors are ready before to is written, and mul_value allows to to be one of them
+            to.mul_value(value(l, tl), value(r, tr));
+            return;
+        }
+        // the left operand goes into to first, so a right operand that reads to needs a fresh result,
+        // unless a sum can take its operands the other way round
+        if (refers(r, to)) {
+            if (Op == expr_op::add && !refers(l, to)) {
+                eval_into(r, to);
+                to.add(value(l, tl), false);
+            } else {
+                big_integer res;
+                eval(res);
+                to = std::move(res);
+            }
+            return;
+        }
+        eval_into(l, to);
+        if (Op == expr_op::rem) {
+            to %= value(r, tr);
+        } else {
+            to.add(value(r, tr), Op == expr_op::sub);
+        }
+    }
+
+private:
+    static bool refers(big_integer const &a, big_integer const &x) {
+        return &a == &x;
+    }
+
+    template<class E>
+    static bool refers(E const &e, big_integer const &x) {
+        return e.refers_to(x);
+    }
+
+    static big_integer const &value(big_integer const &a, big_integer &) {
+        return a;
+    }
+
+    template<class E>
+    static big_integer const &value(E const &e, big_integer &tmp) {
+        e.eval(tmp);
+        return tmp;
+    }
+
+    static void eval_into(big_integer const &a, big_integer &to) {
+        to.copy_value(a);
+    }
+
+    template<class E>
+    static void eval_into(E const &e, big_integer &to) {
+        e.eval(to);
+    }
+};
+
+template<class T>
+struct is_big_integer_expr : std::false_type {
+};
+
+template<expr_op Op, class L, class R>
+struct is_big_integer_expr<big_integer_expr<Op, L, R>> : std::true_type {
+};
+
+// T as deduced by a forwarding reference: a big_integer lvalue or any node
+template<class T, class D = std::decay_t<T>>
+struct is_big_integer_operand
+        : std::integral_constant<bool, is_big_integer_expr<D>::value ||
+                                       (std::is_same<D, big_integer>::value && std::is_lvalue_reference<T>::value)> {
+};
+
+// both sides are big_integer lvalues or nodes, and at least one is a node
+template<class L, class R>
+using enable_if_expr_t = std::enable_if_t<is_big_integer_operand<L>::value && is_big_integer_operand<R>::value &&
+                                          (is_big_integer_expr<std::decay_t<L>>::value ||
+                                           is_big_integer_expr<std::decay_t<R>>::value)>;
+
+inline big_integer_expr<expr_op::add, big_integer, big_integer> operator+(big_integer const &a, big_integer const &b) {
+    return {a, b};
+}
+
+inline big_integer_expr<expr_op::sub, big_integer, big_integer> operator-(big_integer const &a, big_integer const &b) {
+    return {a, b};
+}
+
+inline big_integer_expr<expr_op::mul, big_integer, big_integer> operator*(big_integer const &a, big_integer const &b) {
+    return {a, b};
+}
+
+inline big_integer_expr<expr_op::rem, big_integer, big_integer> operator%(big_integer const &a, big_integer const &b) {
+    return {a, b};
+}
+
+template<class L, class R, class = enable_if_expr_t<L, R>>
+big_integer_expr<expr_op::add, std::decay_t<L>, std::decay_t<R>> operator+(L &&a, R &&b) {
+    return {std::forward<L>(a), std::forward<R>(b)};
+}
+
+template<class L, class R, class = enable_if_expr_t<L, R>>
+big_integer_expr<expr_op::sub, std::decay_t<L>, std::decay_t<R>> operator-(L &&a, R &&b) {
+    return {std::forward<L>(a), std::forward<R>(b)};
+}
+
+template<class L, class R, class = enable_if_expr_t<L, R>>
+big_integer_expr<expr_op::mul, std::decay_t<L>, std::decay_t<R>> operator*(L &&a, R &&b) {
+    return {std::forward<L>(a), std::forward<R>(b)};
+}
+
+template<class L, class R, class = enable_if_expr_t<L, R>>
+big_integer_expr<expr_op::rem, std::decay_t<L>, std::decay_t<R>> operator%(L &&a, R &&b) {
+    return {std::forward<L>(a), std::forward<R>(b)};
+}
+
 big_integer abs(big_integer const &a);
 
-big_integer operator+(big_integer a, big_integer const &b);
+// a temporary operand is updated in place and returned instead
+big_integer operator+(big_integer &&a, big_integer const &b);
+
+big_integer operator+(big_integer const &a, big_integer &&b);
+
+big_integer operator+(big_integer &&a, big_integer &&b);
 
-big_integer operator-(big_integer a, big_integer const &b);
+big_integer operator-(big_integer &&a, big_integer const &b);
+
+big_integer operator-(big_integer const &a, big_integer &&b);
+
+big_integer operator-(big_integer &&a, big_integer &&b);
+
+big_integer operator*(big_integer &&a, big_integer const &b);
+
+big_integer operator*(big_integer const &a, big_integer &&b);
+
+big_integer operator*(big_integer &&a, big_integer &&b);
 
 big_integer operator*(big_integer a, uint32_t const &b);
 
-big_integer operator*(big_integer a, big_integer const &b);
+big_integer operator*(big_integer a, int b);
+
+big_integer square(big_integer const &a);
+
+// acc += a * b and acc -= a * b straight in the limbs of acc, which may also be a or b
+void addmul(big_integer &acc, big_integer const &a, big_integer const &b);
+
+void submul(big_integer &acc, big_integer const &a, big_integer const &b);
+
+void addmul(big_integer &acc, big_integer const &a, uint32_t b);
+
+void submul(big_integer &acc, big_integer const &a, uint32_t b);
+
+void addmul(big_integer &acc, big_integer const &a, int b);
+
+void submul(big_integer &acc, big_integer const &a, int b);
+
+// r = a + b, r = a - b, r = a * b into the limbs r already has; r may be a or b
+void add(big_integer &r, big_integer const &a, big_integer const &b);
+
+void sub(big_integer &r, big_integer const &a, big_integer const &b);
+
+void mul(big_integer &r, big_integer const &a, big_integer const &b);
 
 big_integer operator/(big_integer a, big_integer const &b);
 
-big_integer operator%(big_integer a, big_integer const &b);
+// the int and uint32_t overloads would be ambiguous for the wider native integers
+template<class T>
+std::enable_if_t<is_wide_integral<T>::value, big_integer> operator*(big_integer const &a, T b) {
+    return a * big_integer(b);
+}
+
+template<class T>
+std::enable_if_t<is_wide_integral<T>::value, big_integer> operator/(big_integer const &a, T b) {
+    return a / big_integer(b);
+}
+
+template<class T>
+std::enable_if_t<is_wide_integral<T>::value, big_integer> operator%(big_integer const &a, T b) {
+    return a % big_integer(b);
+}
+
+big_integer operator%(big_integer &&a, big_integer const &b);
+
+big_integer operator%(big_integer const &a, big_integer &&b);
+
+big_integer operator%(big_integer &&a, big_integer &&b);
+
+// quotient and remainder from a single division, a = q * b + r
+std::pair<big_integer, big_integer> divmod(big_integer const &a, big_integer const &b,
+                                           rounding mode = rounding::truncate);
+
+// quotient truncated toward zero and the remainder with the sign of a, in one pass over a
+std::pair<big_integer, big_integer> divmod(big_integer const &a, uint32_t b);
+
+std::pair<big_integer, big_integer> divmod(big_integer const &a, uint64_t b);
+
+std::pair<big_integer, big_integer> divmod(big_integer const &a, int b);
+
+// q = n / d truncated toward zero and r = n % d with the sign of n, written over the limbs of q and r;
+// q and r must be different objects, but either may be n or d
+void tdiv_qr(big_integer &q, big_integer &r, big_integer const &n, big_integer const &d);
+
+big_integer operator/(big_integer const &a, uint32_t b);
+
+big_integer operator/(big_integer const &a, int b);
+
+big_integer operator%(big_integer a, uint32_t b);
+
+big_integer operator%(big_integer a, int b);
 
 big_integer operator&(big_integer a, big_integer const &b);
 
@@ -128,6 +484,12 @@ big_integer operator|(big_integer a, big_integer const &b);
 
 big_integer operator^(big_integer a, big_integer const &b);
 
+big_integer operator&(big_integer const &a, big_integer &&b);
+
+big_integer operator|(big_integer const &a, big_integer &&b);
+
+big_integer operator^(big_integer const &a, big_integer &&b);
+
 big_integer operator<<(big_integer a, int b);
 
 big_integer operator>>(big_integer a, int b);
@@ -144,7 +506,85 @@ bool operator<=(big_integer const &a, big_integer const &b);
 
 bool operator>=(big_integer const &a, big_integer const &b);
 
-std::string to_string(big_integer const &a);
+// negative, zero or positive as a is less than, equal to or greater than b; never allocates
+int compare(big_integer const &a, big_integer const &b);
+
+int compare(big_integer const &a, int64_t b);
+
+int compare(big_integer const &a, uint64_t b);
+
+template<class T>
+std::enable_if_t<std::is_integral<T>::value, int> compare(big_integer const &a, T b) {
+    return (std::is_signed<T>::value ? compare(a, static_cast<int64_t>(b)) : compare(a, static_cast<uint64_t>(b)));
+}
+
+// comparisons against native integers skip building a big_integer for the other side
+template<class T>
+std::enable_if_t<std::is_integral<T>::value, bool> operator==(big_integer const &a, T b) {
+    return compare(a, b) == 0;
+}
+
+template<class T>
+std::enable_if_t<std::is_integral<T>::value, bool> operator!=(big_integer const &a, T b) {
+    return compare(a, b) != 0;
+}
+
+template<class T>
+std::enable_if_t<std::is_integral<T>::value, bool> operator<(big_integer const &a, T b) {
+    return compare(a, b) < 0;
+}
+
+template<class T>
+std::enable_if_t<std::is_integral<T>::value, bool> operator>(big_integer const &a, T b) {
+    return compare(a, b) > 0;
+}
+
+template<class T>
+std::enable_if_t<std::is_integral<T>::value, bool> operator<=(big_integer const &a, T b) {
+    return compare(a, b) <= 0;
+}
+
+template<class T>
+std::enable_if_t<std::is_integral<T>::value, bool> operator>=(big_integer const &a, T b) {
+    return compare(a, b) >= 0;
+}
+
+template<class T>
+std::enable_if_t<std::is_integral<T>::value, bool> operator==(T a, big_integer const &b) {
+    return compare(b, a) == 0;
+}
+
+template<class T>
+std::enable_if_t<std::is_integral<T>::value, bool> operator!=(T a, big_integer const &b) {
+    return compare(b, a) != 0;
+}
+
+template<class T>
+std::enable_if_t<std::is_integral<T>::value, bool> operator<(T a, big_integer const &b) {
+    return compare(b, a) > 0;
+}
+
+template<class T>
+std::enable_if_t<std::is_integral<T>::value, bool> operator>(T a, big_integer const &b) {
+    return compare(b, a) < 0;
+}
+
+template<class T>
+std::enable_if_t<std::is_integral<T>::value, bool> operator<=(T a, big_integer const &b) {
+    return compare(b, a) >= 0;
+}
+
+template<class T>
+std::enable_if_t<std::is_integral<T>::value, bool> operator>=(T a, big_integer const &b) {
+    return compare(b, a) <= 0;
+}
+
+// sign and magnitude, so negative numbers print as '-' followed by their absolute value in any base
+std::string to_string(big_integer const &a, unsigned base = 10);
+
+big_integer from_string(std::string const &str, unsigned base = 10);
+
+limbs::mul_tier mul_tier_for(big_integer const &a, big_integer const &b);
 
 std::ostream &operator<<(std::ostream &s, big_integer const &a);
 
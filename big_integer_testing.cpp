@@ -1,6 +1,7 @@
 #include <algorithm>
 #include <cassert>
 #include <cstdlib>
+#include <limits>
 #include <vector>
 #include <utility>
 #include <gtest/gtest.h>
@@ -735,3 +736,688 @@ TEST(correctness, div_randomized)
         EXPECT_LT(residue, divisor);
     }
 }
+
+namespace
+{
+    uint32_t rand_limb()
+    {
+        return (static_cast<uint32_t>(rand()) << 16u) ^ static_cast<uint32_t>(rand());
+    }
+
+    big_integer rand_limbs(size_t size)
+    {
+        if (size == 1)
+        {
+            big_integer limb = rand_limb();
+            for (unsigned i = 32; i < LIMB_BITS; i += 32)
+                limb = (limb << 32) + rand_limb();
+            return limb;
+        }
+
+        size_t half = size / 2;
+        return (rand_limbs(size - half) << static_cast<int>(LIMB_BITS * half)) + rand_limbs(half);
+    }
+
+    // multiplies by 16-limb slices of a, so every product stays in the schoolbook range
+    big_integer sliced_mul(big_integer const& a, size_t a_size, big_integer const& b)
+    {
+        big_integer const mask = (big_integer(1) << static_cast<int>(16 * LIMB_BITS)) - 1;
+        big_integer result = 0;
+
+        for (size_t i = 0; i < a_size; i += 16)
+        {
+            int shift = static_cast<int>(LIMB_BITS * i);
+            result += (((a >> shift) & mask) * b) << shift;
+        }
+
+        return result;
+    }
+}
+
+TEST(correctness, mul_karatsuba)
+{
+    for (size_t size : {40, 64, 101, 333})
+    {
+        big_integer a = rand_limbs(size);
+        big_integer b = rand_limbs(size);
+        big_integer ab = sliced_mul(a, size, b);
+
+        EXPECT_EQ(a * b, ab);
+        EXPECT_EQ(-a * b, -ab);
+        EXPECT_EQ(-a * -b, ab);
+    }
+}
+
+TEST(correctness, mul_unbalanced)
+{
+    big_integer a = rand_limbs(1000);
+    big_integer b = rand_limbs(70);
+    big_integer ab = sliced_mul(a, 1000, b);
+
+    EXPECT_EQ(a * b, ab);
+    EXPECT_EQ(b * a, ab);
+    EXPECT_EQ((a * b) / b, a);
+}
+
+TEST(correctness, mul_toom)
+{
+    for (size_t size : {150, 300, 500, 1000})
+    {
+        big_integer a = rand_limbs(size);
+        big_integer b = rand_limbs(size);
+
+        EXPECT_EQ(a * b, sliced_mul(a, size, b));
+        EXPECT_EQ(a * -a, -sliced_mul(a, size, a));
+    }
+}
+
+TEST(correctness, mul_tier)
+{
+    EXPECT_EQ(mul_tier_for(rand_limbs(10), rand_limbs(10)), limbs::mul_tier::schoolbook);
+    EXPECT_EQ(mul_tier_for(rand_limbs(100), rand_limbs(100)), limbs::mul_tier::karatsuba);
+    EXPECT_EQ(mul_tier_for(rand_limbs(200), rand_limbs(200)), limbs::mul_tier::toom3);
+    EXPECT_EQ(mul_tier_for(rand_limbs(1000), rand_limbs(1000)), limbs::mul_tier::toom4);
+    EXPECT_EQ(mul_tier_for(rand_limbs(1000), rand_limbs(20)), limbs::mul_tier::schoolbook);
+    EXPECT_EQ(mul_tier_for(-rand_limbs(1000), rand_limbs(200)), limbs::mul_tier::toom3);
+}
+
+TEST(correctness, mul_ntt)
+{
+    size_t const size = 10000;
+    int const half = LIMB_BITS * size / 2;
+    big_integer a = rand_limbs(size);
+    big_integer b = rand_limbs(size);
+    big_integer a_lo = a & ((big_integer(1) << half) - 1);
+    big_integer a_hi = a >> half;
+
+    EXPECT_EQ(mul_tier_for(a, b), limbs::mul_tier::ntt);
+    EXPECT_EQ(a * b, ((a_hi * b) << half) + a_lo * b);
+    EXPECT_EQ(a * -b, -(((a_hi * b) << half) + a_lo * b));
+}
+
+TEST(correctness, mul_ntt_max_limbs)
+{
+    int const bits = LIMB_BITS * 8000;
+    big_integer a = (big_integer(1) << bits) - 1;
+
+    EXPECT_EQ(a * a, (big_integer(1) << (2 * bits)) - (big_integer(1) << (bits + 1)) + 1);
+}
+
+TEST(correctness, square)
+{
+    EXPECT_EQ(square(big_integer(0)), 0);
+    EXPECT_EQ(square(big_integer(-3)), 9);
+    EXPECT_EQ(square(big_integer(std::numeric_limits<int>::min())), big_integer(1) << 62);
+
+    for (size_t size : {7, 40, 100, 200, 700, 7000})
+    {
+        big_integer a = rand_limbs(size);
+        big_integer b = -a;
+        big_integer aa = (size < 1000 ? sliced_mul(a, size, a) : a * (a + 1) - a);
+
+        EXPECT_EQ(square(a), aa);
+        EXPECT_EQ(square(b), aa);
+        EXPECT_EQ(a * a, aa);
+        b *= b;
+        EXPECT_EQ(b, aa);
+    }
+}
+
+TEST(correctness, square_detection)
+{
+    big_integer a = rand_limbs(40);
+    big_integer b = a;
+    big_integer c = a + 0;
+
+    EXPECT_EQ(mul_tier_for(a, b), limbs::mul_tier::schoolbook);
+    EXPECT_EQ(mul_tier_for(a, c), limbs::mul_tier::karatsuba);
+    EXPECT_EQ(a * b, a * c);
+}
+
+TEST(correctness, div_burnikel_ziegler)
+{
+    for (size_t size : {160, 400, 1000, 5000})
+    {
+        big_integer divisor = rand_limbs(size);
+        big_integer quotient = rand_limbs(size + size / 3);
+        big_integer residue = rand_limbs(size - 1);
+        big_integer divident = quotient * divisor + residue;
+
+        EXPECT_EQ(divident / divisor, quotient);
+        EXPECT_EQ(divident % divisor, residue);
+        EXPECT_EQ(-divident / divisor, -quotient);
+        EXPECT_EQ((quotient * divisor) / divisor, quotient);
+        EXPECT_EQ((quotient * divisor - 1) / divisor, quotient - 1);
+    }
+}
+
+TEST(correctness, div_newton)
+{
+    size_t const size = limbs::NEWTON_THRESHOLD;
+    big_integer divisor = rand_limbs(size);
+    big_integer quotient = rand_limbs(size + 7);
+    big_integer residue = rand_limbs(size - 1);
+    big_integer divident = quotient * divisor + residue;
+
+    EXPECT_EQ(divident / divisor, quotient);
+    EXPECT_EQ(divident % divisor, residue);
+    EXPECT_EQ((quotient * divisor - 1) / divisor, quotient - 1);
+}
+
+TEST(correctness, div_basecase)
+{
+    for (size_t size = 2; size < limbs::BZ_THRESHOLD; size += 13)
+    {
+        big_integer divisor = rand_limbs(size);
+        big_integer quotient = rand_limbs(size / 2 + 1);
+        big_integer residue = rand_limbs(size - 1);
+        big_integer divident = quotient * divisor + residue;
+
+        EXPECT_EQ(divident / divisor, quotient);
+        EXPECT_EQ(divident % divisor, residue);
+        EXPECT_EQ(-divident / divisor, -quotient);
+    }
+
+    // divisor with its top bit already set needs no normalization shift
+    big_integer divisor = (big_integer(1) << static_cast<int>(3 * LIMB_BITS - 1)) + rand_limbs(2);
+    big_integer quotient = rand_limbs(4);
+    EXPECT_EQ((quotient * divisor + divisor - 1) / divisor, quotient);
+    EXPECT_EQ((quotient * divisor + divisor - 1) % divisor, divisor - 1);
+}
+
+TEST(correctness, kernel_tails)
+{
+    // every length around the unrolled blocks of the add / addmul / submul kernels
+    for (size_t size = 1; size <= 20; size++)
+    {
+        big_integer a = rand_limbs(size);
+        big_integer b = 0;
+        big_integer expected = 0;
+        for (size_t i = 0; i < size * LIMB_BITS / 32; i++)
+        {
+            uint32_t piece = rand_limb() | 1u;
+            b += big_integer(piece) << static_cast<int>(32 * i);
+            expected += (a * piece) << static_cast<int>(32 * i);
+        }
+        big_integer residue = b - 1;
+
+        EXPECT_EQ(a * b, expected);
+        EXPECT_EQ((a * b + residue) / b, a);
+        EXPECT_EQ(a + b - b, a);
+    }
+}
+
+TEST(correctness, kernel_variant)
+{
+    std::string variant = limbs::kernel_variant();
+#if defined(__x86_64__) && defined(__GNUC__)
+    EXPECT_EQ(variant.compare(0, 6, "x86-64"), 0);
+#else
+    EXPECT_EQ(variant, "generic");
+#endif
+}
+
+TEST(correctness, divmod_small)
+{
+    big_integer a = rand_limbs(50);
+    for (uint32_t d : {1u, 3u, 1000000000u, UINT32_MAX})
+    {
+        std::pair<big_integer, big_integer> qr = divmod(a, d);
+        EXPECT_EQ(qr.first, a / big_integer(d));
+        EXPECT_EQ(qr.second, a % big_integer(d));
+        EXPECT_EQ(a / d, qr.first);
+        EXPECT_EQ(-a % d, -qr.second);
+    }
+
+    uint64_t const d = (static_cast<uint64_t>(rand_limb()) << 32u) | rand_limb();
+    big_integer bd = (big_integer(static_cast<uint32_t>(d >> 32u)) << 32) + big_integer(static_cast<uint32_t>(d));
+    std::pair<big_integer, big_integer> qr = divmod(-a, d);
+    EXPECT_EQ(qr.first, -a / bd);
+    EXPECT_EQ(qr.second, -a % bd);
+    EXPECT_EQ(divmod(big_integer(7), d).second, 7);
+
+    EXPECT_EQ(a / -3, -(a / 3));
+    EXPECT_EQ(a % -3, a % 3);
+    EXPECT_EQ(-a / -3, a / 3);
+    EXPECT_THROW(divmod(a, 0u), std::runtime_error);
+}
+
+TEST(correctness, mul_small)
+{
+    big_integer a("2147483648");
+    EXPECT_EQ(a * 2u, big_integer("4294967296"));
+    EXPECT_EQ(a * -2, big_integer("-4294967296"));
+    EXPECT_EQ(-a * UINT32_MAX, big_integer("-9223372034707292160"));
+
+    big_integer b = rand_limbs(20);
+    EXPECT_EQ(b * -7, -(b * big_integer(7)));
+    big_integer c = b;
+    c *= -7;
+    EXPECT_EQ(c, b * -7);
+}
+
+TEST(correctness, divmod_rounding)
+{
+    int const cases[][2] = {{7, 2}, {-7, 2}, {7, -2}, {-7, -2}, {6, 3}, {-6, 3}, {1, 5}, {-1, -5}};
+    int const trunc[][2] = {{3, 1}, {-3, -1}, {-3, 1}, {3, -1}, {2, 0}, {-2, 0}, {0, 1}, {0, -1}};
+    int const floor[][2] = {{3, 1}, {-4, 1}, {-4, -1}, {3, -1}, {2, 0}, {-2, 0}, {0, 1}, {0, -1}};
+    int const euclid[][2] = {{3, 1}, {-4, 1}, {-3, 1}, {4, 1}, {2, 0}, {-2, 0}, {0, 1}, {1, 4}};
+    for (size_t i = 0; i < 8; i++)
+    {
+        big_integer a = cases[i][0], b = cases[i][1];
+        std::pair<big_integer, big_integer> t = divmod(a, b), f = divmod(a, b, rounding::floor),
+                e = divmod(a, b, rounding::euclid);
+        EXPECT_EQ(t.first, trunc[i][0]);
+        EXPECT_EQ(t.second, trunc[i][1]);
+        EXPECT_EQ(f.first, floor[i][0]);
+        EXPECT_EQ(f.second, floor[i][1]);
+        EXPECT_EQ(e.first, euclid[i][0]);
+        EXPECT_EQ(e.second, euclid[i][1]);
+    }
+
+    big_integer a = -rand_limbs(400), b = rand_limbs(170);
+    std::pair<big_integer, big_integer> qr = divmod(a, b, rounding::euclid);
+    EXPECT_EQ(qr.first * b + qr.second, a);
+    EXPECT_TRUE(qr.second >= 0 && qr.second < b);
+    EXPECT_EQ(divmod(a, b).first, a / b);
+    EXPECT_EQ(divmod(a, b).second, a % b);
+    EXPECT_THROW(divmod(a, big_integer()), std::runtime_error);
+}
+
+TEST(correctness, to_string_divide_and_conquer)
+{
+    std::string digits(5000, '0');
+    for (char &c : digits)
+        c = static_cast<char>('0' + rand() % 10);
+    digits[0] = '7';
+    EXPECT_EQ(to_string(big_integer(digits)), digits);
+    EXPECT_EQ(to_string(-big_integer(digits)), "-" + digits);
+
+    // zero runs in the middle have to survive the padding of the lower halves
+    big_integer power = 1;
+    for (int i = 0; i < 4000; i++)
+        power *= 10;
+    EXPECT_EQ(to_string(power), "1" + std::string(4000, '0'));
+    EXPECT_EQ(to_string(power - 1), std::string(4000, '9'));
+    EXPECT_EQ(to_string(power * power + 3), "1" + std::string(7999, '0') + "3");
+}
+
+TEST(correctness, string_ctor_divide_and_conquer)
+{
+    std::string digits(20000, '0');
+    for (char &c : digits)
+        c = static_cast<char>('0' + rand() % 10);
+    digits[0] = '3';
+    big_integer a(digits);
+    EXPECT_EQ(to_string(a), digits);
+    EXPECT_EQ(big_integer("-" + digits), -a);
+    EXPECT_EQ(big_integer("000" + digits), a);
+
+    big_integer power = 1;
+    for (int i = 0; i < 3000; i++)
+        power *= 10;
+    EXPECT_EQ(big_integer("1" + std::string(3000, '0')), power);
+    EXPECT_EQ(big_integer(std::string(3000, '9')), power - 1);
+    EXPECT_EQ(big_integer("-1" + std::string(2999, '0') + "7"), -(power + 7));
+}
+
+TEST(correctness, pow2_base_io)
+{
+    big_integer a("deadbeef0123456789abcdef", 16);
+    EXPECT_EQ(to_string(a, 16), "deadbeef0123456789abcdef");
+    EXPECT_EQ(big_integer("DEADBEEF0123456789ABCDEF", 16), a);
+    EXPECT_EQ(to_string(-a, 16), "-deadbeef0123456789abcdef");
+    EXPECT_EQ(big_integer("-deadbeef0123456789abcdef", 16), -a);
+
+    EXPECT_EQ(to_string(big_integer(255), 2), "11111111");
+    EXPECT_EQ(to_string(big_integer(-8), 8), "-10");
+    EXPECT_EQ(to_string(big_integer(0), 32), "0");
+    EXPECT_EQ(to_string(big_integer(1023), 32), "vv");
+    EXPECT_EQ(big_integer("-100000000000000000000000000000000", 2), -(big_integer(1) << 32));
+
+    big_integer b = -rand_limbs(300);
+    for (unsigned base : {2u, 4u, 8u, 16u, 32u})
+    {
+        EXPECT_EQ(big_integer(to_string(b, base), base), b);
+    }
+    EXPECT_EQ(big_integer(to_string(b, 16), 16), big_integer(to_string(b)));
+
+    EXPECT_THROW(big_integer("12", 63), std::runtime_error);
+    EXPECT_THROW(to_string(big_integer(12), 1), std::runtime_error);
+    EXPECT_THROW(big_integer("102", 2), std::runtime_error);
+    EXPECT_THROW(big_integer("0x10", 16), std::runtime_error);
+}
+
+TEST(correctness, radix_io)
+{
+    EXPECT_EQ(to_string(big_integer(35), 36), "z");
+    EXPECT_EQ(from_string("Z", 36), 35);
+    EXPECT_EQ(to_string(big_integer(61), 62), "z");
+    EXPECT_EQ(to_string(big_integer(35), 62), "Z");
+    EXPECT_EQ(from_string("10", 62), 62);
+    EXPECT_EQ(to_string(big_integer(-80), 3), "-2222");
+    EXPECT_THROW(from_string("3", 3), std::runtime_error);
+
+    big_integer a = rand_limbs(600);
+    std::string const decimal = to_string(a);
+    for (unsigned base = 2; base <= 62; base += 5)
+    {
+        std::string s = to_string(-a, base);
+        EXPECT_EQ(from_string(s, base), -a);
+        EXPECT_EQ(to_string(from_string(s, base)), "-" + decimal);
+    }
+}
+
+TEST(correctness, compare_native)
+{
+    int64_t const values[] = {0, 1, -1, INT32_MAX, INT32_MIN, 2147483648LL, -4294967296LL, 4294967295LL,
+                              INT64_MAX, INT64_MIN};
+    for (int64_t x : values)
+    {
+        big_integer bx = (big_integer(static_cast<int>(x >> 32)) << 32) + big_integer(static_cast<uint32_t>(x));
+        for (int64_t y : values)
+        {
+            big_integer by = (big_integer(static_cast<int>(y >> 32)) << 32) + big_integer(static_cast<uint32_t>(y));
+            EXPECT_EQ(compare(bx, y) < 0, x < y);
+            EXPECT_EQ(compare(bx, y) == 0, x == y);
+            EXPECT_EQ(compare(bx, by) > 0, x > y);
+            EXPECT_EQ(bx < y, x < y);
+            EXPECT_EQ(y <= bx, y <= x);
+        }
+    }
+
+    big_integer big = big_integer(1) << 64;
+    EXPECT_TRUE(big > UINT64_MAX);
+    EXPECT_TRUE(big - 1 == UINT64_MAX);
+    EXPECT_TRUE(-big < INT64_MIN);
+    EXPECT_TRUE(-(big >> 1) == INT64_MIN);
+    EXPECT_TRUE(0u < big && big != 5 && 7 != big);
+
+    big_integer a = rand_limbs(30), b = a + 1;
+    EXPECT_TRUE(a < b && -b < -a && -a < a && compare(a, a) == 0);
+}
+
+TEST(correctness, bitwise_long)
+{
+    big_integer one = 1, high = big_integer(1) << 100;
+    EXPECT_EQ(one | high, high + 1);
+    EXPECT_EQ(one ^ high, high + 1);
+    EXPECT_EQ(-one & high, high);
+    EXPECT_EQ(one & -high, 0);
+
+    for (size_t size : {1, 5, 17, 100, 1000})
+    {
+        for (size_t other : {3, 40, 700})
+        {
+            big_integer a = rand_limbs(size), b = -rand_limbs(other);
+            for (int i = 0; i < 2; i++)
+            {
+                EXPECT_EQ((a | b), (a ^ b) + (a & b));
+                EXPECT_EQ((b | a), (a ^ b) + (a & b));
+                EXPECT_EQ(a + b, (a ^ b) + 2 * (a & b));
+                EXPECT_EQ(~a, -a - 1);
+                a = -a;
+            }
+        }
+    }
+}
+
+TEST(correctness, limbs_spans)
+{
+    // the kernel layer straight on caller-owned buffers
+    std::vector<limb_t> a(30), b(20), p(50), q(31), r(20), s(30);
+    for (limb_t &x : a)
+        x = rand_limb();
+    for (limb_t &x : b)
+        x = rand_limb();
+    b.back() |= 1;
+
+    limbs::mul(p.data(), a.data(), a.size(), b.data(), b.size());
+    limbs::divrem(q.data(), r.data(), p.data(), p.size(), b.data(), b.size());
+    EXPECT_TRUE(std::equal(a.begin(), a.end(), q.begin()));
+    EXPECT_EQ(q.back(), 0u);
+    EXPECT_EQ(limbs::normalized_size(r.data(), r.size()), 0u);
+
+    limb_t carry = limbs::add(s.data(), a.data(), a.size(), b.data(), b.size());
+    EXPECT_EQ(limbs::sub(s.data(), s.data(), s.size(), b.data(), b.size()), carry);
+    EXPECT_EQ(limbs::cmp(s.data(), a.data(), a.size()), 0);
+
+    limb_t out = limbs::lshift(s.data(), a.data(), a.size(), 7);
+    limbs::rshift(s.data(), s.data(), s.size(), 7);
+    s.back() |= out << (LIMB_BITS - 7);
+    EXPECT_EQ(s, a);
+}
+
+TEST(correctness, move_semantics)
+{
+    big_integer a = rand_limbs(50);
+    big_integer b = -rand_limbs(40);
+    big_integer const sum = a + b, diff = a - b;
+
+    big_integer c(std::move(a));
+    EXPECT_EQ(a, 0);
+    a = std::move(c);
+    EXPECT_EQ(c, 0);
+    c = std::move(a);
+    a = c;
+    EXPECT_EQ(a, c);
+
+    // the destination's old value does not end up in the source
+    big_integer d = b;
+    d = std::move(c);
+    EXPECT_EQ(d, a);
+    EXPECT_EQ(c, 0);
+    d = std::move(d);
+    c = d;
+    EXPECT_EQ(c, a);
+
+    EXPECT_EQ(big_integer(a) + big_integer(b), sum);
+    EXPECT_EQ(a + big_integer(b), sum);
+    EXPECT_EQ(a - big_integer(b), diff);
+    EXPECT_EQ(b - big_integer(a), -diff);
+    EXPECT_EQ(-(a + b), -sum);
+    EXPECT_EQ(~(a + b), -sum - 1);
+    EXPECT_EQ(a & big_integer(b), a & b);
+    EXPECT_EQ(a | big_integer(b), a | b);
+    EXPECT_EQ(a ^ big_integer(b), a ^ b);
+    EXPECT_EQ(((a + b) - (a - b) + 2 * b) * 1, 4 * b);
+}
+
+TEST(correctness, fused_expressions)
+{
+    for (int i = 0; i < 20; i++)
+    {
+        big_integer a = rand_limbs(30 + i), b = -rand_limbs(20), c = rand_limbs(45), m = rand_limbs(10) + 1;
+        big_integer ab = a;
+        ab *= b;
+        big_integer const abc = ab + c, ab_m = ab % m, apb_c = (ab - ab) + a + b - c;
+
+        big_integer r = a * b + c;
+        EXPECT_EQ(r, abc);
+        r = (a + b) - c;
+        EXPECT_EQ(r, apb_c);
+        r = a * b % m;
+        EXPECT_EQ(r, ab_m);
+        EXPECT_EQ(big_integer(a * b + c), abc);
+        EXPECT_EQ(to_string(a * b + c), to_string(abc));
+
+        // the destination is also an operand
+        r = a;
+        r = r * b + c;
+        EXPECT_EQ(r, abc);
+        r = c;
+        r = a * b + r;
+        EXPECT_EQ(r, abc);
+        r = c;
+        r = (a + b) - r;
+        EXPECT_EQ(r, apb_c);
+        r = m;
+        r = a * b % r;
+        EXPECT_EQ(r, ab_m);
+        r = a;
+        r = r * r - a * a;
+        EXPECT_EQ(r, 0);
+        r = b;
+        r = (a * r + c) * m % (m + r) - r;
+        EXPECT_EQ(r, (abc * m) % (m + b) - b);
+    }
+}
+
+TEST(correctness, expression_temporaries)
+{
+    big_integer a = rand_limbs(30), b = -rand_limbs(20), c = rand_limbs(40);
+    big_integer const ab = big_integer(a) *= b;
+
+    // temporaries are consumed at once instead of being referred to by a node
+    EXPECT_TRUE((std::is_same<decltype(a * big_integer(b)), big_integer>::value));
+    EXPECT_TRUE((std::is_same<decltype(big_integer(a) % b), big_integer>::value));
+    EXPECT_TRUE((std::is_same<decltype(a * b + big_integer(c)), big_integer>::value));
+
+    big_integer r = big_integer(a) * big_integer(b) + big_integer(c);
+    EXPECT_EQ(r, ab + c);
+    r = (a * b) % big_integer(c) - big_integer(c) * 2;
+    EXPECT_EQ(r, ab % c - 2 * c);
+
+    // nodes built inside a function from temporaries or from nested nodes survive being returned
+    auto product_plus_one = [](big_integer const &x, big_integer const &y)
+    {
+        return x * y + big_integer(1);
+    };
+    auto nested = [](big_integer const &x, big_integer const &y)
+    {
+        return (x + y) * (x - y);
+    };
+    r = product_plus_one(a, b);
+    EXPECT_EQ(r, ab + 1);
+    r = nested(a, b);
+    EXPECT_EQ(r, square(a) - square(b));
+
+    // over by-value parameters an auto return type would deduce a node referring to them, so the result is
+    // spelled big_integer and evaluated before they are destroyed
+    auto by_value = [](big_integer x, big_integer y) -> big_integer
+    {
+        EXPECT_FALSE((std::is_same<decltype(x * y + x), big_integer>::value));
+        return x * y + x;
+    };
+    r = by_value(a, b);
+    EXPECT_EQ(r, ab + a);
+    r = by_value(big_integer(a) + 1, -big_integer(b));
+    EXPECT_EQ(r, -ab - b + a + 1);
+    auto kept = (a * b) + (c * c);
+    r = kept;
+    EXPECT_EQ(r, ab + square(c));
+}
+
+TEST(correctness, wide_native_operands)
+{
+    big_integer a = rand_limbs(5);
+
+    EXPECT_EQ(big_integer(-1L), -1);
+    EXPECT_EQ(big_integer(std::numeric_limits<long long>::min()), -(big_integer(1) << 63));
+    EXPECT_EQ(big_integer(std::numeric_limits<unsigned long long>::max()), (big_integer(1) << 64) - 1);
+    EXPECT_EQ(big_integer(1234567890123LL), big_integer("1234567890123"));
+
+    EXPECT_EQ(a * 3L, a * 3);
+    EXPECT_EQ(3LL * a, a * 3);
+    EXPECT_EQ(a + 3L, a + 3);
+    EXPECT_EQ(3UL - a, 3 - a);
+    EXPECT_EQ(a / -7LL, a / -7);
+    EXPECT_EQ(a % 7UL, a % 7);
+    EXPECT_EQ(a * 4294967296LL, a << 32);
+    EXPECT_TRUE(a * 2L > 2L);
+}
+
+TEST(correctness, addmul_submul)
+{
+    for (size_t an : {1, 3, 20, 70, 150})
+    {
+        for (size_t bn : {1, 2, 17, 50, 120})
+        {
+            big_integer a = rand_limbs(an), b = -rand_limbs(bn), acc = rand_limbs(25);
+            big_integer const start = acc;
+            big_integer const ab = big_integer(a) * big_integer(b);
+
+            addmul(acc, a, b);
+            EXPECT_EQ(acc, start + ab);
+            submul(acc, b, a);
+            EXPECT_EQ(acc, start);
+            submul(acc, a, a);
+            EXPECT_EQ(acc, start - square(a));
+            acc = -start;
+            addmul(acc, b, b);
+            EXPECT_EQ(acc, square(b) - start);
+
+            acc = start;
+            acc += a * b;
+            EXPECT_EQ(acc, start + ab);
+            acc -= (a + 1) * b;
+            EXPECT_EQ(acc, start - b);
+
+            // the accumulator is a factor itself
+            acc = a;
+            addmul(acc, acc, b);
+            EXPECT_EQ(acc, a + ab);
+            acc = b;
+            submul(acc, a, acc);
+            EXPECT_EQ(acc, b - ab);
+        }
+    }
+    big_integer a = rand_limbs(9), acc = -rand_limbs(3);
+    big_integer const start = acc;
+    addmul(acc, a, 7u);
+    EXPECT_EQ(acc, start + a * 7);
+    submul(acc, a, -7);
+    EXPECT_EQ(acc, start + a * 14);
+    submul(acc, a, 14);
+    EXPECT_EQ(acc, start);
+    addmul(acc, a, -3);
+    EXPECT_EQ(acc, start - a * 3);
+    addmul(acc, a, 0);
+    EXPECT_EQ(acc, start - a * 3);
+}
+
+TEST(correctness, output_parameters)
+{
+    for (int i = 0; i < 10; i++)
+    {
+        big_integer a = rand_limbs(40), b = -rand_limbs(15 + i);
+        big_integer const sum = big_integer(a) + b, prod = big_integer(a) * b;
+        std::pair<big_integer, big_integer> const qr = divmod(a, b);
+        big_integer r, q;
+
+        add(r, a, b);
+        EXPECT_EQ(r, sum);
+        sub(r, r, b);
+        EXPECT_EQ(r, a);
+        sub(r, b, r);
+        EXPECT_EQ(r, big_integer(b) - a);
+        mul(r, a, b);
+        EXPECT_EQ(r, prod);
+        r = a;
+        mul(r, r, r);
+        EXPECT_EQ(r, square(a));
+
+        tdiv_qr(q, r, a, b);
+        EXPECT_EQ(q, qr.first);
+        EXPECT_EQ(r, qr.second);
+        // quotient or remainder over an operand
+        q = a;
+        tdiv_qr(q, r, q, b);
+        EXPECT_EQ(q, qr.first);
+        EXPECT_EQ(r, qr.second);
+        r = a;
+        tdiv_qr(q, r, r, b);
+        EXPECT_EQ(q, qr.first);
+        EXPECT_EQ(r, qr.second);
+        r = b;
+        tdiv_qr(q, r, a, r);
+        EXPECT_EQ(q, qr.first);
+        EXPECT_EQ(r, qr.second);
+        q = b;
+        tdiv_qr(q, r, q, a);
+        EXPECT_EQ(q, 0);
+        EXPECT_EQ(r, b);
+    }
+    big_integer q, r;
+    EXPECT_THROW(tdiv_qr(q, r, big_integer(5), big_integer()), std::runtime_error);
+}
@@ -0,0 +1,19 @@
+#ifndef BIG_INTEGER_LIMB_H
+#define BIG_INTEGER_LIMB_H
+
+#include <cstdint>
+
+// Digit type of big_integer. Building with BIG_INTEGER_LIMB64 defined (the CMake option of the same name)
+// switches to 64-bit limbs with unsigned __int128 double limbs, which needs GCC or Clang on a 64-bit target.
+#ifdef BIG_INTEGER_LIMB64
+typedef uint64_t limb_t;
+__extension__ typedef unsigned __int128 dlimb_t;
+#else
+typedef uint32_t limb_t;
+typedef uint64_t dlimb_t;
+#endif
+
+unsigned const LIMB_BITS = 8 * sizeof(limb_t);
+limb_t const LIMB_MAX = ~static_cast<limb_t>(0);
+
+#endif //BIG_INTEGER_LIMB_H
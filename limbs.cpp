@@ -0,0 +1,1259 @@
+#include "limbs.h"
+#include "limbs_x86.h"
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+namespace {
+    // portable kernels, bound until bind_kernels() finds something faster
+    limb_t add_n_generic(limb_t *r, limb_t const *a, limb_t const *b, size_t n) {
+        dlimb_t carry = 0;
+        for (size_t i = 0; i < n; i++) {
+            carry += static_cast<dlimb_t>(a[i]) + b[i];
+            r[i] = static_cast<limb_t>(carry);
+            carry >>= LIMB_BITS;
+        }
+        return static_cast<limb_t>(carry);
+    }
+
+    limb_t sub_n_generic(limb_t *r, limb_t const *a, limb_t const *b, size_t n) {
+        limb_t borrow = 0;
+        for (size_t i = 0; i < n; i++) {
+            dlimb_t tmp = static_cast<dlimb_t>(a[i]) - b[i] - borrow;
+            r[i] = static_cast<limb_t>(tmp);
+            borrow = static_cast<limb_t>(tmp >> (2 * LIMB_BITS - 1));
+        }
+        return borrow;
+    }
+
+    limb_t mul_1_generic(limb_t *r, limb_t const *a, size_t n, limb_t b) {
+        dlimb_t carry = 0;
+        for (size_t i = 0; i < n; i++) {
+            carry += static_cast<dlimb_t>(a[i]) * b;
+            r[i] = static_cast<limb_t>(carry);
+            carry >>= LIMB_BITS;
+        }
+        return static_cast<limb_t>(carry);
+    }
+
+    limb_t addmul_1_generic(limb_t *r, limb_t const *a, size_t n, limb_t b) {
+        dlimb_t carry = 0;
+        for (size_t i = 0; i < n; i++) {
+            carry += static_cast<dlimb_t>(a[i]) * b + r[i];
+            r[i] = static_cast<limb_t>(carry);
+            carry >>= LIMB_BITS;
+        }
+        return static_cast<limb_t>(carry);
+    }
+
+    limb_t submul_1_generic(limb_t *r, limb_t const *a, size_t n, limb_t b) {
+        limb_t borrow = 0;
+        for (size_t i = 0; i < n; i++) {
+            dlimb_t prod = static_cast<dlimb_t>(a[i]) * b + borrow;
+            limb_t lo = static_cast<limb_t>(prod);
+            borrow = static_cast<limb_t>(prod >> LIMB_BITS) + (r[i] < lo);
+            r[i] -= lo;
+        }
+        return borrow;
+    }
+
+    limb_t lshift_generic(limb_t *r, limb_t const *a, size_t n, unsigned cnt) {
+        if (cnt == 0) {
+            std::copy_backward(a, a + n, r + n);
+            return 0;
+        }
+        limb_t out = a[n - 1] >> (LIMB_BITS - cnt);
+        for (size_t i = n - 1; i > 0; i--)
+            r[i] = (a[i] << cnt) | (a[i - 1] >> (LIMB_BITS - cnt));
+        r[0] = a[0] << cnt;
+        return out;
+    }
+
+    limb_t rshift_generic(limb_t *r, limb_t const *a, size_t n, unsigned cnt) {
+        if (cnt == 0) {
+            std::copy(a, a + n, r);
+            return 0;
+        }
+        limb_t out = a[0] << (LIMB_BITS - cnt);
+        for (size_t i = 0; i + 1 < n; i++)
+            r[i] = (a[i] >> cnt) | (a[i + 1] << (LIMB_BITS - cnt));
+        r[n - 1] = a[n - 1] >> cnt;
+        return out;
+    }
+
+    void and_n_generic(limb_t *r, limb_t const *a, limb_t const *b, size_t n) {
+        for (size_t i = 0; i < n; i++)
+            r[i] = a[i] & b[i];
+    }
+
+    void ior_n_generic(limb_t *r, limb_t const *a, limb_t const *b, size_t n) {
+        for (size_t i = 0; i < n; i++)
+            r[i] = a[i] | b[i];
+    }
+
+    void xor_n_generic(limb_t *r, limb_t const *a, limb_t const *b, size_t n) {
+        for (size_t i = 0; i < n; i++)
+            r[i] = a[i] ^ b[i];
+    }
+
+    void com_generic(limb_t *r, limb_t const *a, size_t n) {
+        for (size_t i = 0; i < n; i++)
+            r[i] = ~a[i];
+    }
+
+    typedef limb_t (*add_n_kernel)(limb_t *, limb_t const *, limb_t const *, size_t);
+    typedef limb_t (*mul_1_kernel)(limb_t *, limb_t const *, size_t, limb_t);
+    typedef limb_t (*shift_kernel)(limb_t *, limb_t const *, size_t, unsigned);
+    typedef void (*bitwise_kernel)(limb_t *, limb_t const *, limb_t const *, size_t);
+    typedef void (*com_kernel)(limb_t *, limb_t const *, size_t);
+
+    struct kernel_table {
+        add_n_kernel add_n, sub_n;
+        mul_1_kernel mul_1, addmul_1, submul_1;
+        shift_kernel lshift, rshift;
+        bitwise_kernel and_n, ior_n, xor_n;
+        com_kernel com;
+        char const *variant;
+    };
+
+    // constant-initialized, so calls from other static initializers are safe before the binding below runs
+    kernel_table kernels = {
+            add_n_generic, sub_n_generic,
+            mul_1_generic, addmul_1_generic, submul_1_generic,
+            lshift_generic, rshift_generic,
+            and_n_generic, ior_n_generic, xor_n_generic,
+            com_generic,
+            "generic"
+    };
+
+    char variant_name[64];
+
+    // probes the CPU once at startup and binds the fastest kernels it supports
+    bool bind_kernels() {
+#ifdef BIG_INTEGER_X86
+        limbs::x86::cpu_features const f = limbs::x86::probe();
+        kernels.add_n = limbs::x86::add_n;
+        kernels.sub_n = limbs::x86::sub_n;
+        std::strcpy(variant_name, "x86-64");
+        if (f.bmi2 && f.adx) {
+            kernels.mul_1 = limbs::x86::mul_1;
+            kernels.addmul_1 = limbs::x86::addmul_1;
+            kernels.submul_1 = limbs::x86::submul_1;
+            std::strcat(variant_name, " bmi2 adx");
+        }
+        if (f.avx512) {
+            kernels.and_n = limbs::x86::and_n_avx512;
+            kernels.ior_n = limbs::x86::ior_n_avx512;
+            kernels.xor_n = limbs::x86::xor_n_avx512;
+            kernels.com = limbs::x86::com_avx512;
+            std::strcat(variant_name, " avx512");
+        } else if (f.avx2) {
+            kernels.and_n = limbs::x86::and_n_avx2;
+            kernels.ior_n = limbs::x86::ior_n_avx2;
+            kernels.xor_n = limbs::x86::xor_n_avx2;
+            kernels.com = limbs::x86::com_avx2;
+            std::strcat(variant_name, " avx2");
+        }
+        kernels.variant = variant_name;
+#endif
+        return true;
+    }
+
+    bool const kernels_bound = bind_kernels();
+}
+
+char const *limbs::kernel_variant() {
+    return kernels.variant;
+}
+
+limb_t limbs::add_n(limb_t *r, limb_t const *a, limb_t const *b, size_t n) {
+    return kernels.add_n(r, a, b, n);
+}
+
+limb_t limbs::sub_n(limb_t *r, limb_t const *a, limb_t const *b, size_t n) {
+    return kernels.sub_n(r, a, b, n);
+}
+
+limb_t limbs::add_1(limb_t *r, limb_t const *a, size_t n, limb_t b) {
+    size_t i = 0;
+    for (; i < n && b != 0; i++) {
+        dlimb_t tmp = static_cast<dlimb_t>(a[i]) + b;
+        r[i] = static_cast<limb_t>(tmp);
+        b = static_cast<limb_t>(tmp >> LIMB_BITS);
+    }
+    if (r != a) std::copy(a + i, a + n, r + i);
+    return b;
+}
+
+limb_t limbs::sub_1(limb_t *r, limb_t const *a, size_t n, limb_t b) {
+    size_t i = 0;
+    for (; i < n && b != 0; i++) {
+        dlimb_t tmp = static_cast<dlimb_t>(a[i]) - b;
+        r[i] = static_cast<limb_t>(tmp);
+        b = static_cast<limb_t>(tmp >> (2 * LIMB_BITS - 1));
+    }
+    if (r != a) std::copy(a + i, a + n, r + i);
+    return b;
+}
+
+limb_t limbs::add(limb_t *r, limb_t const *a, size_t an, limb_t const *b, size_t bn) {
+    return add_1(r + bn, a + bn, an - bn, add_n(r, a, b, bn));
+}
+
+limb_t limbs::sub(limb_t *r, limb_t const *a, size_t an, limb_t const *b, size_t bn) {
+    return sub_1(r + bn, a + bn, an - bn, sub_n(r, a, b, bn));
+}
+
+limb_t limbs::mul_1(limb_t *r, limb_t const *a, size_t n, limb_t b) {
+    return kernels.mul_1(r, a, n, b);
+}
+
+limb_t limbs::addmul_1(limb_t *r, limb_t const *a, size_t n, limb_t b) {
+    return kernels.addmul_1(r, a, n, b);
+}
+
+limb_t limbs::submul_1(limb_t *r, limb_t const *a, size_t n, limb_t b) {
+    return kernels.submul_1(r, a, n, b);
+}
+
+limb_t limbs::lshift(limb_t *r, limb_t const *a, size_t n, unsigned cnt) {
+    return kernels.lshift(r, a, n, cnt);
+}
+
+limb_t limbs::rshift(limb_t *r, limb_t const *a, size_t n, unsigned cnt) {
+    return kernels.rshift(r, a, n, cnt);
+}
+
+void limbs::and_n(limb_t *r, limb_t const *a, limb_t const *b, size_t n) {
+    kernels.and_n(r, a, b, n);
+}
+
+void limbs::ior_n(limb_t *r, limb_t const *a, limb_t const *b, size_t n) {
+    kernels.ior_n(r, a, b, n);
+}
+
+void limbs::xor_n(limb_t *r, limb_t const *a, limb_t const *b, size_t n) {
+    kernels.xor_n(r, a, b, n);
+}
+
+void limbs::com(limb_t *r, limb_t const *a, size_t n) {
+    kernels.com(r, a, n);
+}
+
+int limbs::cmp(limb_t const *a, limb_t const *b, size_t n) {
+    while (n > 0) {
+        n--;
+        if (a[n] != b[n])
+            return (a[n] < b[n] ? -1 : 1);
+    }
+    return 0;
+}
+
+size_t limbs::normalized_size(limb_t const *a, size_t n) {
+    while (n > 0 && a[n - 1] == 0)
+        n--;
+    return n;
+}
+
+void limbs::mul_basecase(limb_t *r, limb_t const *a, size_t an, limb_t const *b, size_t bn) {
+    r[an] = mul_1(r, a, an, b[0]);
+    for (size_t j = 1; j < bn; j++) {
+        r[an + j] = addmul_1(r + j, a, an, b[j]);
+    }
+}
+
+void limbs::sqr_basecase(limb_t *r, limb_t const *a, size_t n) {
+    // products a[i] * a[j] with i < j, each computed once
+    r[0] = 0;
+    r[2 * n - 1] = 0;
+    if (n > 1) {
+        r[n] = mul_1(r + 1, a + 1, n - 1, a[0]);
+        for (size_t i = 1; i + 1 < n; i++) {
+            r[n + i] = addmul_1(r + 2 * i + 1, a + i + 1, n - i - 1, a[i]);
+        }
+    }
+    for (size_t i = 2 * n - 1; i > 0; i--) {
+        r[i] = (r[i] << 1u) | (r[i - 1] >> (LIMB_BITS - 1));
+    }
+    r[0] <<= 1u;
+    limb_t carry = 0;
+    for (size_t i = 0; i < n; i++) {
+        dlimb_t sq = static_cast<dlimb_t>(a[i]) * a[i];
+        dlimb_t lo = static_cast<dlimb_t>(r[2 * i]) + static_cast<limb_t>(sq) + carry;
+        dlimb_t hi = static_cast<dlimb_t>(r[2 * i + 1]) + (sq >> LIMB_BITS) + (lo >> LIMB_BITS);
+        r[2 * i] = static_cast<limb_t>(lo);
+        r[2 * i + 1] = static_cast<limb_t>(hi);
+        carry = static_cast<limb_t>(hi >> LIMB_BITS);
+    }
+}
+
+namespace {
+    using namespace limbs;
+
+    // r[0, an) = |a - b|, an >= bn; returns true when a < b
+    bool sub_abs(limb_t *r, limb_t const *a, size_t an, limb_t const *b, size_t bn) {
+        if (normalized_size(a, an) <= bn && cmp(a, b, bn) < 0) {
+            sub_n(r, b, a, bn);
+            std::fill(r + bn, r + an, 0);
+            return true;
+        }
+        sub(r, a, an, b, bn);
+        return false;
+    }
+
+    size_t karatsuba_scratch(size_t n) {
+        size_t s = 0;
+        while (n >= KARATSUBA_THRESHOLD) {
+            size_t h = n - n / 2;
+            s += 6 * h + 1;
+            n = h;
+        }
+        return s;
+    }
+
+    void karatsuba(limb_t *r, limb_t const *a, limb_t const *b, size_t n, limb_t *scratch);
+
+    void mul_n_rec(limb_t *r, limb_t const *a, limb_t const *b, size_t n, limb_t *scratch) {
+        if (a == b && n < SQR_KARATSUBA_THRESHOLD) {
+            sqr_basecase(r, a, n);
+        } else if (n < KARATSUBA_THRESHOLD) {
+            mul_basecase(r, a, n, b, n);
+        } else {
+            karatsuba(r, a, b, n, scratch);
+        }
+    }
+
+    // a = a1 * B^h + a0, b = b1 * B^h + b0
+    // a * b = z2 * B^2h + (z0 + z2 - (a0 - a1)(b0 - b1)) * B^h + z0
+    void karatsuba(limb_t *r, limb_t const *a, limb_t const *b, size_t n, limb_t *scratch) {
+        size_t h = n - n / 2, l = n / 2;
+        limb_t *da = scratch, *db = scratch + h, *z1 = scratch + 2 * h, *mid = scratch + 4 * h;
+        limb_t *next = scratch + 6 * h + 1;
+
+        bool neg = false;
+        if (a == b) {
+            sub_abs(da, a, h, a + h, l);
+            db = da;
+        } else {
+            neg = sub_abs(da, a, h, a + h, l) != sub_abs(db, b, h, b + h, l);
+        }
+
+        mul_n_rec(r, a, b, h, next);
+        mul_n_rec(r + 2 * h, a + h, b + h, l, next);
+        mul_n_rec(z1, da, db, h, next);
+
+        mid[2 * h] = add(mid, r, 2 * h, r + 2 * h, 2 * l);
+        if (neg) {
+            mid[2 * h] += add_n(mid, mid, z1, 2 * h);
+        } else {
+            mid[2 * h] -= sub_n(mid, mid, z1, 2 * h);
+        }
+        add(r + h, r + h, 2 * n - h, mid, std::min(2 * h + 1, 2 * n - h));
+    }
+
+    // Toom interpolation runs on w-limb two's complement numbers: all the
+    // intermediate values fit, so plain modular add/sub/mul are exact.
+
+    void set_signed(limb_t *r, size_t w, limb_t const *a, size_t n, bool neg) {
+        std::copy(a, a + n, r);
+        std::fill(r + n, r + w, 0);
+        if (neg) {
+            for (size_t i = 0; i < w; i++)
+                r[i] = ~r[i];
+            add_1(r, r, w, 1);
+        }
+    }
+
+    // exact division by 2^bits
+    void rshift_signed(limb_t *r, size_t w, unsigned bits) {
+        limb_t fill = (r[w - 1] >> (LIMB_BITS - 1) ? ~(LIMB_MAX >> bits) : 0);
+        for (size_t i = 0; i + 1 < w; i++)
+            r[i] = (r[i] >> bits) | (r[i + 1] << (LIMB_BITS - bits));
+        r[w - 1] = (r[w - 1] >> bits) | fill;
+    }
+
+    // exact division by an odd d, computed modulo B^w
+    void divexact_odd(limb_t *r, size_t w, limb_t d) {
+        limb_t inv = d;
+        for (int i = 0; i < 5; i++)
+            inv *= 2 - d * inv;
+        limb_t borrow = 0;
+        for (size_t i = 0; i < w; i++) {
+            limb_t s = r[i];
+            limb_t c = (s < borrow);
+            s -= borrow;
+            r[i] = s * inv;
+            borrow = static_cast<limb_t>((static_cast<dlimb_t>(r[i]) * d) >> LIMB_BITS) + c;
+        }
+    }
+
+    // adds a nonnegative w-limb value to r[0, rn) starting at limb pos
+    void add_at(limb_t *r, size_t rn, size_t pos, limb_t const *a, size_t w) {
+        w = normalized_size(a, w);
+        if (w != 0)
+            add(r + pos, r + pos, rn - pos, a, w);
+    }
+
+    // a = a2 * x^2 + a1 * x + a0, x = B^k, evaluated at 0, 1, -1, 2 and infinity
+    void toom3(limb_t *r, limb_t const *a, limb_t const *b, size_t n) {
+        size_t k = (n + 2) / 3, s = n - 2 * k, e = k + 1, w = 2 * k + 3;
+        bool square = (a == b);
+        std::vector<limb_t> buf(6 * e + 3 * w);
+        limb_t *ea1 = buf.data(), *eam1 = ea1 + e, *ea2 = eam1 + e;
+        limb_t *eb1 = ea2 + e, *ebm1 = eb1 + e, *eb2 = ebm1 + e;
+        limb_t *v1 = eb2 + e, *vm1 = v1 + w, *v2 = vm1 + w;
+
+        auto evaluate = [&](limb_t const *p, limb_t *p1, limb_t *pm1, limb_t *p2) {
+            p1[k] = add(p1, p, k, p + 2 * k, s);
+            bool neg = sub_abs(pm1, p1, e, p + k, k);
+            p1[k] += add_n(p1, p1, p + k, k);
+            std::copy(p + 2 * k, p + n, p2);
+            std::fill(p2 + s, p2 + e, 0);
+            mul_1(p2, p2, e, 2);
+            add(p2, p2, e, p + k, k);
+            mul_1(p2, p2, e, 2);
+            add(p2, p2, e, p, k);
+            return neg;
+        };
+        bool neg = evaluate(a, ea1, eam1, ea2);
+        if (square) {
+            eb1 = ea1, ebm1 = eam1, eb2 = ea2;
+            neg = false;
+        } else {
+            neg ^= evaluate(b, eb1, ebm1, eb2);
+        }
+
+        mul_n(r, a, b, k);
+        mul_n(r + 4 * k, a + 2 * k, b + 2 * k, s);
+        std::fill(r + 2 * k, r + 4 * k, 0);
+        limb_t const *c0 = r, *c4 = r + 4 * k;
+
+        std::vector<limb_t> prod(2 * e);
+        mul_n(prod.data(), ea1, eb1, e);
+        set_signed(v1, w, prod.data(), 2 * e, false);
+        mul_n(prod.data(), eam1, ebm1, e);
+        set_signed(vm1, w, prod.data(), 2 * e, neg);
+        mul_n(prod.data(), ea2, eb2, e);
+        set_signed(v2, w, prod.data(), 2 * e, false);
+
+        // v1 <- c1 + c3, vm1 <- c2
+        add_n(vm1, vm1, v1, w);
+        add_n(v1, v1, v1, w);
+        sub_n(v1, v1, vm1, w);
+        rshift_signed(v1, w, 1);
+        rshift_signed(vm1, w, 1);
+        sub(vm1, vm1, w, c0, 2 * k);
+        sub(vm1, vm1, w, c4, 2 * s);
+        // v2 <- c3, v1 <- c1
+        sub(v2, v2, w, c0, 2 * k);
+        submul_1(v2, vm1, w, 4);
+        sub_1(v2 + 2 * s, v2 + 2 * s, w - 2 * s, submul_1(v2, c4, 2 * s, 16));
+        rshift_signed(v2, w, 1);
+        sub_n(v2, v2, v1, w);
+        divexact_odd(v2, w, 3);
+        sub_n(v1, v1, v2, w);
+
+        add_at(r, 2 * n, k, v1, w);
+        add_at(r, 2 * n, 2 * k, vm1, w);
+        add_at(r, 2 * n, 3 * k, v2, w);
+    }
+
+    // a = a3 * x^3 + a2 * x^2 + a1 * x + a0, x = B^k, evaluated at 0, 1, -1, 2, -2, 1/2 and infinity
+    void toom4(limb_t *r, limb_t const *a, limb_t const *b, size_t n) {
+        size_t k = (n + 3) / 4, s = n - 3 * k, e = k + 1, w = 2 * k + 3;
+        bool square = (a == b);
+        std::vector<limb_t> buf(12 * e + 7 * w);
+        limb_t *ea[5], *eb[5], *v[5];
+        for (size_t i = 0; i < 5; i++) {
+            ea[i] = buf.data() + i * e;
+            eb[i] = buf.data() + (5 + i) * e;
+            v[i] = buf.data() + 10 * e + i * w;
+        }
+        limb_t *tmp = buf.data() + 10 * e + 5 * w, *t = tmp + 2 * e;
+
+        // points 1, -1, 2, -2, 1/2 (scaled by 8)
+        auto evaluate = [&](limb_t const *p, limb_t **ev) {
+            limb_t *even = t, *odd = t + e;
+            even[k] = add(even, p, k, p + 2 * k, k);
+            odd[k] = add(odd, p + k, k, p + 3 * k, s);
+            add_n(ev[0], even, odd, e);
+            bool neg1 = sub_abs(ev[1], even, e, odd, e);
+
+            std::copy(p, p + k, even);
+            even[k] = addmul_1(even, p + 2 * k, k, 4);
+            std::fill(odd, odd + e, 0);
+            odd[s] = mul_1(odd, p + 3 * k, s, 4);
+            add(odd, odd, e, p + k, k);
+            mul_1(odd, odd, e, 2);
+            add_n(ev[2], even, odd, e);
+            bool neg2 = sub_abs(ev[3], even, e, odd, e);
+
+            limb_t *h = ev[4];
+            std::copy(p, p + k, h);
+            h[k] = 0;
+            mul_1(h, h, e, 2);
+            add(h, h, e, p + k, k);
+            mul_1(h, h, e, 2);
+            add(h, h, e, p + 2 * k, k);
+            mul_1(h, h, e, 2);
+            add(h, h, e, p + 3 * k, s);
+            return (neg1 ? 1 : 0) | (neg2 ? 2 : 0);
+        };
+        // bit 0: the value at -1 is negative, bit 1: the value at -2 is negative
+        int signs = evaluate(a, ea);
+        if (square) {
+            std::copy(ea, ea + 5, eb);
+            signs = 0;
+        } else {
+            signs ^= evaluate(b, eb);
+        }
+
+        mul_n(r, a, b, k);
+        mul_n(r + 6 * k, a + 3 * k, b + 3 * k, s);
+        std::fill(r + 2 * k, r + 6 * k, 0);
+        limb_t const *c0 = r, *c6 = r + 6 * k;
+
+        bool negs[5] = {false, (signs & 1) != 0, false, (signs & 2) != 0, false};
+        for (size_t i = 0; i < 5; i++) {
+            mul_n(tmp, ea[i], eb[i], e);
+            set_signed(v[i], w, tmp, 2 * e, negs[i]);
+        }
+        limb_t *v1 = v[0], *vm1 = v[1], *v2 = v[2], *vm2 = v[3], *vh = v[4];
+
+        // v1 <- c1 + c3 + c5, vm1 <- c0 + c2 + c4 + c6
+        add_n(vm1, vm1, v1, w);
+        add_n(v1, v1, v1, w);
+        sub_n(v1, v1, vm1, w);
+        rshift_signed(v1, w, 1);
+        rshift_signed(vm1, w, 1);
+        // v2 <- c1 + 4 c3 + 16 c5, vm2 <- c0 + 4 c2 + 16 c4 + 64 c6
+        add_n(vm2, vm2, v2, w);
+        add_n(v2, v2, v2, w);
+        sub_n(v2, v2, vm2, w);
+        rshift_signed(v2, w, 2);
+        rshift_signed(vm2, w, 1);
+        // vm1 <- c2 + c4, vm2 <- c2 + 4 c4
+        sub(vm1, vm1, w, c0, 2 * k);
+        sub(vm1, vm1, w, c6, 2 * s);
+        sub(vm2, vm2, w, c0, 2 * k);
+        sub_1(vm2 + 2 * s, vm2 + 2 * s, w - 2 * s, submul_1(vm2, c6, 2 * s, 64));
+        rshift_signed(vm2, w, 2);
+        // vm2 <- c4, vm1 <- c2
+        sub_n(vm2, vm2, vm1, w);
+        divexact_odd(vm2, w, 3);
+        sub_n(vm1, vm1, vm2, w);
+        // vh <- 16 c1 + 4 c3 + c5
+        sub_1(vh + 2 * k, vh + 2 * k, w - 2 * k, submul_1(vh, c0, 2 * k, 64));
+        submul_1(vh, vm1, w, 16);
+        submul_1(vh, vm2, w, 4);
+        sub(vh, vh, w, c6, 2 * s);
+        rshift_signed(vh, w, 1);
+        // v2 <- c3 + 5 c5, vh <- 4 c3 + 5 c5
+        sub_n(v2, v2, v1, w);
+        divexact_odd(v2, w, 3);
+        mul_1(tmp, v1, w, 16);
+        sub_n(vh, tmp, vh, w);
+        divexact_odd(vh, w, 3);
+        // vh <- c3, v2 <- c5, v1 <- c1
+        sub_n(vh, vh, v2, w);
+        divexact_odd(vh, w, 3);
+        sub_n(v2, v2, vh, w);
+        divexact_odd(v2, w, 5);
+        sub_n(v1, v1, vh, w);
+        sub_n(v1, v1, v2, w);
+
+        add_at(r, 2 * n, k, v1, w);
+        add_at(r, 2 * n, 2 * k, vm1, w);
+        add_at(r, 2 * n, 3 * k, vh, w);
+        add_at(r, 2 * n, 4 * k, vm2, w);
+        add_at(r, 2 * n, 5 * k, v2, w);
+    }
+
+    // arithmetic modulo an NTT-friendly prime p < 2^30, values in Montgomery form (x * 2^32 mod p)
+    struct ntt_prime {
+        uint32_t p, g, p_inv, r2;
+
+        ntt_prime(uint32_t p, uint32_t g) : p(p), g(g), p_inv(p) {
+            for (int i = 0; i < 5; i++)
+                p_inv *= 2 - p * p_inv;
+            p_inv = 0 - p_inv;
+            uint64_t r = (static_cast<uint64_t>(1) << 32u) % p;
+            r2 = static_cast<uint32_t>(r * r % p);
+        }
+
+        uint32_t reduce(uint64_t t) const {
+            uint32_t m = static_cast<uint32_t>(t) * p_inv;
+            uint32_t r = static_cast<uint32_t>((t + static_cast<uint64_t>(m) * p) >> 32u);
+            return (r >= p ? r - p : r);
+        }
+
+        uint32_t mul(uint32_t a, uint32_t b) const {
+            return reduce(static_cast<uint64_t>(a) * b);
+        }
+
+        uint32_t add(uint32_t a, uint32_t b) const {
+            uint32_t r = a + b;
+            return (r >= p ? r - p : r);
+        }
+
+        uint32_t sub(uint32_t a, uint32_t b) const {
+            return (a >= b ? a - b : a + p - b);
+        }
+
+        uint32_t to_mont(uint32_t a) const {
+            return mul(a, r2);
+        }
+
+        uint32_t pow(uint32_t a, uint64_t e) const {
+            uint32_t res = to_mont(1);
+            for (; e != 0; e >>= 1u) {
+                if (e & 1u)
+                    res = mul(res, a);
+                a = mul(a, a);
+            }
+            return res;
+        }
+    };
+
+    ntt_prime const ntt_primes[3] = {{998244353, 3}, {167772161, 3}, {469762049, 3}};
+
+    // rt[m + j] = w^j for the primitive 2m-th root of unity w, m = 1, 2, 4, ... n / 2
+    void ntt_roots(uint32_t *rt, size_t n, ntt_prime const &f) {
+        for (size_t m = 1; m < n; m <<= 1u) {
+            uint32_t w = f.pow(f.to_mont(f.g), (f.p - 1) / (2 * m));
+            rt[m] = f.to_mont(1);
+            for (size_t j = 1; j < m; j++)
+                rt[m + j] = f.mul(rt[m + j - 1], w);
+        }
+    }
+
+    // decimation in frequency, the output is in bit-reversed order
+    void ntt_forward(uint32_t *a, size_t n, uint32_t const *rt, ntt_prime const f) {
+        for (size_t m = n / 2; m >= 1; m >>= 1u) {
+            for (size_t i = 0; i < n; i += 2 * m) {
+                uint32_t *x = a + i, *y = a + i + m;
+                for (size_t j = 0; j < m; j++) {
+                    uint32_t u = x[j], v = y[j];
+                    x[j] = f.add(u, v);
+                    y[j] = f.mul(f.sub(u, v), rt[m + j]);
+                }
+            }
+        }
+    }
+
+    // decimation in time with inverse roots (w^-j = -w^(m - j)), leaves the result multiplied by n
+    void ntt_inverse(uint32_t *a, size_t n, uint32_t const *rt, ntt_prime const f) {
+        for (size_t m = 1; m < n; m <<= 1u) {
+            for (size_t i = 0; i < n; i += 2 * m) {
+                uint32_t *x = a + i, *y = a + i + m;
+                uint32_t u = x[0], v = y[0];
+                x[0] = f.add(u, v);
+                y[0] = f.sub(u, v);
+                for (size_t j = 1; j < m; j++) {
+                    u = x[j];
+                    v = f.mul(y[j], f.p - rt[2 * m - j]);
+                    x[j] = f.add(u, v);
+                    y[j] = f.sub(u, v);
+                }
+            }
+        }
+    }
+
+    uint64_t pow_mod(uint64_t a, uint64_t e, uint64_t p) {
+        uint64_t res = 1;
+        for (a %= p; e != 0; e >>= 1u) {
+            if (e & 1u)
+                res = res * a % p;
+            a = a * a % p;
+        }
+        return res;
+    }
+
+    // 32-bit pieces of the limbs are the transform coefficients
+    size_t const PIECES = LIMB_BITS / 32;
+
+    // convolution of the 32-bit pieces modulo three primes, recombined with the Chinese remainder theorem;
+    // an + bn - 1 <= NTT_MAX_SIZE keeps every coefficient below the product of the primes
+    void mul_ntt(limb_t *r, limb_t const *a, size_t an, limb_t const *b, size_t bn) {
+        bool square = (a == b && an == bn);
+        an *= PIECES;
+        bn *= PIECES;
+        size_t rn = an + bn - 1, len = 1;
+        while (len < rn)
+            len <<= 1u;
+        auto piece = [](limb_t const *p, size_t i) {
+            return static_cast<uint32_t>(p[i / PIECES] >> (32 * (i % PIECES)));
+        };
+
+        std::vector<uint32_t> rt(len), fb(square ? 0 : len);
+        std::vector<uint32_t> res[3];
+        for (size_t k = 0; k < 3; k++) {
+            ntt_prime const &f = ntt_primes[k];
+            std::vector<uint32_t> &fa = res[k];
+            fa.assign(len, 0);
+            for (size_t i = 0; i < an; i++)
+                fa[i] = f.to_mont(piece(a, i));
+            ntt_roots(rt.data(), len, f);
+            ntt_forward(fa.data(), len, rt.data(), f);
+            if (square) {
+                for (size_t i = 0; i < len; i++)
+                    fa[i] = f.mul(fa[i], fa[i]);
+            } else {
+                std::fill(fb.begin(), fb.end(), 0);
+                for (size_t i = 0; i < bn; i++)
+                    fb[i] = f.to_mont(piece(b, i));
+                ntt_forward(fb.data(), len, rt.data(), f);
+                for (size_t i = 0; i < len; i++)
+                    fa[i] = f.mul(fa[i], fb[i]);
+            }
+            ntt_inverse(fa.data(), len, rt.data(), f);
+            // multiplying by plain (non-Montgomery) 1/len both scales and leaves Montgomery form
+            uint32_t len_inv = static_cast<uint32_t>(pow_mod(len, f.p - 2, f.p));
+            for (size_t i = 0; i < rn; i++)
+                fa[i] = f.mul(fa[i], len_inv);
+        }
+
+        std::fill(r, r + (rn + 1) / PIECES, 0);
+        uint64_t const p0 = ntt_primes[0].p, p1 = ntt_primes[1].p, p2 = ntt_primes[2].p;
+        uint64_t const p01 = p0 * p1;
+        uint64_t const inv0 = pow_mod(p0, p1 - 2, p1), inv01 = pow_mod(p01 % p2, p2 - 2, p2);
+        uint64_t carry = 0;
+        for (size_t i = 0; i <= rn; i++) {
+            uint64_t sum = carry;
+            carry = 0;
+            if (i < rn) {
+                uint64_t r0 = res[0][i], r1 = res[1][i], r2 = res[2][i];
+                uint64_t t1 = (r1 + p1 - r0 % p1) * inv0 % p1;
+                uint64_t x = r0 + p0 * t1;
+                uint64_t t2 = (r2 + p2 - x % p2) * inv01 % p2;
+                // coefficient = x + p01 * t2 < 2^87, added to the running carry 32 bits at a time
+                uint64_t lo = (p01 & UINT32_MAX) * t2, hi = (p01 >> 32u) * t2;
+                sum += (x & UINT32_MAX) + (lo & UINT32_MAX);
+                carry = (x >> 32u) + (lo >> 32u) + hi;
+            }
+            carry += sum >> 32u;
+            r[i / PIECES] |= static_cast<limb_t>(static_cast<uint32_t>(sum)) << (32 * (i % PIECES));
+        }
+    }
+}
+
+limbs::mul_tier limbs::mul_tier_for(size_t an, size_t bn) {
+    size_t n = std::min(an, bn);
+    if (n < KARATSUBA_THRESHOLD)
+        return mul_tier::schoolbook;
+    if (n < TOOM3_THRESHOLD)
+        return mul_tier::karatsuba;
+    if (n < TOOM4_THRESHOLD)
+        return mul_tier::toom3;
+    if (n < NTT_THRESHOLD || 2 * n - 1 > NTT_MAX_SIZE)
+        return mul_tier::toom4;
+    return mul_tier::ntt;
+}
+
+limbs::mul_tier limbs::sqr_tier_for(size_t n) {
+    return (n < SQR_KARATSUBA_THRESHOLD ? mul_tier::schoolbook : std::max(mul_tier_for(n, n), mul_tier::karatsuba));
+}
+
+void limbs::mul_n(limb_t *r, limb_t const *a, limb_t const *b, size_t n) {
+    mul_tier tier = (a == b ? sqr_tier_for(n) : mul_tier_for(n, n));
+    switch (tier) {
+        case mul_tier::schoolbook:
+            if (a == b) {
+                sqr_basecase(r, a, n);
+            } else {
+                mul_basecase(r, a, n, b, n);
+            }
+            break;
+        case mul_tier::karatsuba: {
+            std::vector<limb_t> scratch(karatsuba_scratch(n));
+            karatsuba(r, a, b, n, scratch.data());
+            break;
+        }
+        case mul_tier::toom3:
+            toom3(r, a, b, n);
+            break;
+        case mul_tier::toom4:
+            toom4(r, a, b, n);
+            break;
+        case mul_tier::ntt:
+            mul_ntt(r, a, n, b, n);
+            break;
+    }
+}
+
+void limbs::sqr(limb_t *r, limb_t const *a, size_t n) {
+    mul_n(r, a, a, n);
+}
+
+void limbs::mul(limb_t *r, limb_t const *a, size_t an, limb_t const *b, size_t bn) {
+    if (a == b && an == bn) {
+        sqr(r, a, an);
+        return;
+    }
+    if (bn < KARATSUBA_THRESHOLD) {
+        mul_basecase(r, a, an, b, bn);
+        return;
+    }
+    if (mul_tier_for(an, bn) == mul_tier::ntt && an + bn - 1 <= NTT_MAX_SIZE) {
+        mul_ntt(r, a, an, b, bn);
+        return;
+    }
+    mul_n(r, a, b, bn);
+    if (an == bn)
+        return;
+    // unbalanced operands: multiply b by bn-limb chunks of a and accumulate
+    std::vector<limb_t> tmp(2 * bn);
+    for (size_t i = bn; i < an; i += bn) {
+        size_t c = std::min(bn, an - i);
+        if (c == bn) {
+            mul_n(tmp.data(), a + i, b, bn);
+        } else {
+            mul(tmp.data(), b, bn, a + i, c);
+        }
+        limb_t carry = add_n(r + i, r + i, tmp.data(), bn);
+        std::copy(tmp.begin() + bn, tmp.begin() + bn + c, r + i + bn);
+        add_1(r + i + bn, r + i + bn, c, carry);
+    }
+}
+
+limb_t limbs::divrem_1(limb_t *q, limb_t const *a, size_t n, limb_t b) {
+    dlimb_t rem = 0;
+    for (size_t i = n; i-- > 0;) {
+        dlimb_t cur = (rem << LIMB_BITS) | a[i];
+        q[i] = static_cast<limb_t>(cur / b);
+        rem = cur % b;
+    }
+    return static_cast<limb_t>(rem);
+}
+
+void limbs::div_basecase(limb_t *q, limb_t *a, size_t an, limb_t const *b, size_t bn) {
+    limb_t b1 = b[bn - 1], b0 = (bn > 1 ? b[bn - 2] : 0);
+    for (size_t j = an - bn; j-- > 0;) {
+        dlimb_t num = (static_cast<dlimb_t>(a[j + bn]) << LIMB_BITS) | a[j + bn - 1];
+        dlimb_t qhat = num / b1, rhat = num % b1;
+        if (qhat > LIMB_MAX) {
+            qhat = LIMB_MAX;
+            rhat = num - qhat * b1;
+        }
+        limb_t next = (j + bn >= 2 ? a[j + bn - 2] : 0);
+        while (rhat <= LIMB_MAX && qhat * b0 > ((rhat << LIMB_BITS) | next)) {
+            qhat--;
+            rhat += b1;
+        }
+        limb_t borrow = submul_1(a + j, b, bn, static_cast<limb_t>(qhat));
+        limb_t top = a[j + bn];
+        a[j + bn] = top - borrow;
+        if (top < borrow) {
+            qhat--;
+            a[j + bn] += add_n(a + j, a + j, b, bn);
+        }
+        q[j] = static_cast<limb_t>(qhat);
+    }
+}
+
+namespace {
+    void div_3n2n(limb_t *q, limb_t *a, limb_t const *b, size_t h, limb_t *tmp);
+
+    // Burnikel-Ziegler: a[0, 2n) / b[0, n) with a[n, 2n) < b, same contract as div_basecase;
+    // tmp holds n limbs and is shared by every node of the recursion
+    void div_2n1n(limb_t *q, limb_t *a, limb_t const *b, size_t n, limb_t *tmp) {
+        if (n % 2 != 0 || n < BZ_THRESHOLD) {
+            div_basecase(q, a, 2 * n, b, n);
+            return;
+        }
+        size_t h = n / 2;
+        div_3n2n(q + h, a + h, b, h, tmp);
+        div_3n2n(q, a, b, h, tmp);
+    }
+
+    // a[0, 3h) / b[0, 2h) with a[h, 3h) < b, b = b1 * B^h + b2
+    void div_3n2n(limb_t *q, limb_t *a, limb_t const *b, size_t h, limb_t *tmp) {
+        limb_t const *b1 = b + h;
+        if (cmp(a + 2 * h, b1, h) < 0) {
+            div_2n1n(q, a + h, b1, h, tmp);
+        } else {
+            // q = B^h - 1, the top half of a equals b1 here
+            std::fill(q, q + h, LIMB_MAX);
+            sub_n(a + 2 * h, a + 2 * h, b1, h);
+            add_1(a + 2 * h, a + 2 * h, h, add_n(a + h, a + h, b1, h));
+        }
+        // the recursive call above is done with tmp by now
+        mul_n(tmp, q, b, h);
+        limb_t borrow = sub(a, a, 3 * h, tmp, 2 * h);
+        while (borrow != 0) {
+            sub_1(q, q, h, 1);
+            borrow -= add(a, a, 3 * h, b, 2 * h);
+        }
+    }
+
+    // normalizes b, then Burnikel-Ziegler over n-limb blocks of a (or the basecase for short divisors);
+    // the shifted operands, the block quotient and the node temporaries share one allocation
+    void divrem_bz(limb_t *q, limb_t *r, limb_t const *a, size_t an, limb_t const *b, size_t bn) {
+        unsigned s = 0;
+        while ((b[bn - 1] << s) >> (LIMB_BITS - 1) == 0)
+            s++;
+
+        if (bn < BZ_THRESHOLD) {
+            std::vector<limb_t> scratch(bn + an + 1);
+            limb_t *nb = scratch.data(), *w = nb + bn;
+            lshift(nb, b, bn, s);
+            w[an] = lshift(w, a, an, s);
+            div_basecase(q, w, an + 1, nb, bn);
+            rshift(r, w, bn, s);
+            return;
+        }
+
+        // pad the divisor with t low zero limbs so that it halves evenly down to the basecase
+        size_t n = bn, k = 0;
+        while (n >= BZ_THRESHOLD) {
+            n = (n + 1) / 2;
+            k++;
+        }
+        n <<= k;
+        size_t t = n - bn;
+
+        size_t blocks = (t + an + 1 + n - 1) / n, rem = (t + an + 1) % n, wn = blocks * n;
+        std::vector<limb_t> scratch(2 * n + 2 * wn, 0);
+        limb_t *nb = scratch.data(), *tmp = nb + n, *w = tmp + n, *nq = w + wn;
+        lshift(nb + t, b, bn, s);
+        w[t + an] = lshift(w + t, a, an, s);
+
+        // n-limb blocks from the top; a short top block is folded into the first step by the basecase
+        size_t i = blocks - 1;
+        if (rem != 0 && rem < BZ_THRESHOLD) {
+            i--;
+            div_basecase(nq + i * n, w + i * n, n + rem + 1, nb, n);
+        }
+        while (i-- > 0)
+            div_2n1n(nq + i * n, w + i * n, nb, n, tmp);
+        std::copy(nq, nq + (an - bn + 1), q);
+        rshift(r, w + t, bn, s);
+    }
+
+    // x[0, k + 2) ~ B^(k + dn) / d for a normalized d, off by at most a few units.
+    // Newton step x' = 2x - d x^2 doubles the precision; only the top k + 2 limbs of d matter at precision k.
+    void reciprocal(limb_t *x, limb_t const *d, size_t dn, size_t k) {
+        size_t m = std::min(dn, k + 2);
+        limb_t const *dt = d + dn - m;
+        if (k < RECIPROCAL_THRESHOLD) {
+            std::vector<limb_t> u(k + m + 1, 0), rem(m);
+            u[k + m] = 1;
+            divrem_bz(x, rem.data(), u.data(), k + m + 1, dt, m);
+            return;
+        }
+        size_t h = (k + 1) / 2 + 1;
+        std::vector<limb_t> y(h + 2), y2(2 * h + 4), t(m + 2 * h + 4), twice(k + 4, 0);
+        reciprocal(y.data(), d, dn, h);
+        sqr(y2.data(), y.data(), h + 2);
+        mul(t.data(), y2.data(), 2 * h + 4, dt, m);
+        // t >> (2h + m - k) limbs approximates d x^2 at the new precision
+        limb_t const *dx2 = t.data() + (2 * h + m - k);
+        twice[k + 2] = lshift(twice.data() + k - h, y.data(), h + 2, 1);
+        sub_n(twice.data(), twice.data(), dx2, k + 4);
+        std::copy(twice.begin(), twice.begin() + k + 2, x);
+    }
+
+    // quotient from the top limbs of a times the reciprocal of b, then fixed up with one multiplication
+    void divrem_newton(limb_t *q, limb_t *r, limb_t const *a, size_t an, limb_t const *b, size_t bn) {
+        unsigned s = 0;
+        while ((b[bn - 1] << s) >> (LIMB_BITS - 1) == 0)
+            s++;
+        size_t qn = an - bn + 1, k = qn + 1, l = an + 1;
+        std::vector<limb_t> nb(bn), na(l), x(k + 2);
+        lshift(nb.data(), b, bn, s);
+        na[an] = lshift(na.data(), a, an, s);
+        reciprocal(x.data(), nb.data(), bn, k);
+
+        size_t ta = std::min(l, k + 2), u = l - ta;
+        std::vector<limb_t> prod(ta + k + 2);
+        mul(prod.data(), x.data(), k + 2, na.data() + u, ta);
+        size_t shift = k + bn - u, tn = qn + 2;
+        std::vector<limb_t> qt(prod.begin() + shift, prod.begin() + shift + tn);
+
+        size_t pn = tn + bn;
+        std::vector<limb_t> p(pn), rem(pn, 0);
+        std::copy(a, a + an, rem.begin());
+        if (tn >= bn) {
+            mul(p.data(), qt.data(), tn, b, bn);
+        } else {
+            mul(p.data(), b, bn, qt.data(), tn);
+        }
+        while (cmp(p.data(), rem.data(), pn) > 0) {
+            sub_1(qt.data(), qt.data(), tn, 1);
+            sub(p.data(), p.data(), pn, b, bn);
+        }
+        sub_n(rem.data(), rem.data(), p.data(), pn);
+        while (normalized_size(rem.data(), pn) > bn || cmp(rem.data(), b, bn) >= 0) {
+            add_1(qt.data(), qt.data(), tn, 1);
+            sub(rem.data(), rem.data(), pn, b, bn);
+        }
+        std::copy(qt.begin(), qt.begin() + qn, q);
+        std::copy(rem.begin(), rem.begin() + bn, r);
+    }
+}
+
+void limbs::divrem(limb_t *q, limb_t *r, limb_t const *a, size_t an, limb_t const *b, size_t bn) {
+    if (bn == 1) {
+        r[0] = divrem_1(q, a, an, b[0]);
+    } else if (bn >= NEWTON_THRESHOLD && an - bn + 1 >= NEWTON_THRESHOLD) {
+        divrem_newton(q, r, a, an, b, bn);
+    } else {
+        divrem_bz(q, r, a, an, b, bn);
+    }
+}
+
+namespace {
+    char const DIGITS_LOWER[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+    // bases above 36 need both cases, upper case comes first as in GMP
+    char const DIGITS_MIXED[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
+
+    char const DIGIT_PAIRS[] =
+            "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+            "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+            "8081828384858687888990919293949596979899";
+
+    // big_base = base^digits is the largest power of base that fits in a limb
+    struct radix {
+        unsigned base, digits;
+        limb_t big_base;
+        char const *alphabet;
+    };
+
+    radix radix_for(unsigned base) {
+        radix rx{base, 0, 1, (base > 36 ? DIGITS_MIXED : DIGITS_LOWER)};
+        while (static_cast<dlimb_t>(rx.big_base) * base <= LIMB_MAX) {
+            rx.big_base *= base;
+            rx.digits++;
+        }
+        return rx;
+    }
+
+    unsigned floor_log2(unsigned x) {
+        unsigned bits = 0;
+        while (x >>= 1u)
+            bits++;
+        return bits;
+    }
+
+    bool is_pow2_base(unsigned base) {
+        return (base & (base - 1)) == 0 && base <= 32;
+    }
+
+    // exactly rx.digits digits of v < rx.big_base
+    void write_chunk(char *s, limb_t v, radix const &rx) {
+        if (rx.base == 10) {
+            // two at a time
+            size_t i = rx.digits;
+            for (; i >= 2; i -= 2) {
+                limb_t pair = v % 100;
+                v /= 100;
+                s[i - 1] = DIGIT_PAIRS[2 * pair + 1];
+                s[i - 2] = DIGIT_PAIRS[2 * pair];
+            }
+            if (i == 1)
+                s[0] = static_cast<char>('0' + v);
+            return;
+        }
+        for (size_t i = rx.digits; i-- > 0; v /= rx.base)
+            s[i] = rx.alphabet[v % rx.base];
+    }
+
+    // big_base^(2^i), built once per base by squaring and shared by every conversion
+    struct radix_power {
+        std::vector<limb_t> p;
+        size_t digits;
+    };
+
+    radix_power const &power_at(radix const &rx, size_t i) {
+        static std::deque<radix_power> powers[limbs::MAX_BASE + 1];
+        static std::mutex lock;
+        std::lock_guard<std::mutex> guard(lock);
+        std::deque<radix_power> &cache = powers[rx.base];
+        if (cache.empty())
+            cache.push_back({{rx.big_base}, rx.digits});
+        while (cache.size() <= i) {
+            radix_power const &last = cache.back();
+            size_t n = last.p.size();
+            std::vector<limb_t> sq(2 * n);
+            sqr(sq.data(), last.p.data(), n);
+            sq.resize(normalized_size(sq.data(), 2 * n));
+            cache.push_back({std::move(sq), 2 * last.digits});
+        }
+        return cache[i];
+    }
+
+    // writes a[0, n) left-padded with zeros to len digits (len = 0: no padding), returns the end of the output
+    char *get_str_basecase(char *s, size_t len, limb_t const *a, size_t n, radix const &rx) {
+        std::vector<limb_t> t(a, a + n), chunks;
+        while (n > 0) {
+            chunks.push_back(divrem_1(t.data(), t.data(), n, rx.big_base));
+            n = normalized_size(t.data(), n);
+        }
+        char top[LIMB_BITS];
+        size_t skip = 0;
+        if (!chunks.empty()) {
+            write_chunk(top, chunks.back(), rx);
+            while (skip + 1 < rx.digits && top[skip] == '0')
+                skip++;
+        }
+        size_t top_len = rx.digits - skip;
+        size_t total = (chunks.empty() ? 0 : top_len + rx.digits * (chunks.size() - 1));
+        if (len > total) {
+            std::fill(s, s + (len - total), '0');
+            s += len - total;
+        }
+        if (chunks.empty())
+            return s;
+        s = std::copy(top + skip, top + rx.digits, s);
+        for (size_t i = chunks.size() - 1; i-- > 0; s += rx.digits)
+            write_chunk(s, chunks[i], rx);
+        return s;
+    }
+
+    // a < big_base^(2^(i + 1)): split by big_base^(2^i) and convert both halves
+    char *get_str_dc(char *s, size_t len, limb_t const *a, size_t n, size_t i, radix const &rx) {
+        if (n < GET_STR_DC_THRESHOLD || i == 0)
+            return get_str_basecase(s, len, a, n, rx);
+        i--;
+        radix_power const &pw = power_at(rx, i);
+        size_t pn = pw.p.size();
+        if (n < pn || (n == pn && cmp(a, pw.p.data(), n) < 0))
+            return get_str_dc(s, len, a, n, i, rx);
+        std::vector<limb_t> q(n - pn + 1), r(pn);
+        divrem(q.data(), r.data(), a, n, pw.p.data(), pn);
+        s = get_str_dc(s, (len > pw.digits ? len - pw.digits : 0), q.data(), normalized_size(q.data(), q.size()), i,
+                       rx);
+        return get_str_dc(s, pw.digits, r.data(), normalized_size(r.data(), pn), i, rx);
+    }
+
+    // one digit per bits-wide field, read straight from the limbs from the top down
+    size_t get_str_pow2(char *s, limb_t const *a, size_t n, unsigned bits) {
+        size_t total = LIMB_BITS * n;
+        for (limb_t top = a[n - 1]; (top >> (LIMB_BITS - 1)) == 0; top <<= 1u)
+            total--;
+        size_t count = (total + bits - 1) / bits;
+        limb_t const mask = (1u << bits) - 1;
+        for (size_t d = count; d-- > 0;) {
+            size_t p = d * bits, i = p / LIMB_BITS;
+            unsigned off = p % LIMB_BITS;
+            limb_t v = a[i] >> off;
+            if (off + bits > LIMB_BITS && i + 1 < n)
+                v |= a[i + 1] << (LIMB_BITS - off);
+            *s++ = DIGITS_LOWER[v & mask];
+        }
+        return count;
+    }
+
+    // Horner over chunks of rx.digits digits, the leading chunk takes the odd ones
+    size_t set_str_basecase(limb_t *r, char const *s, size_t len, radix const &rx) {
+        size_t n = 0;
+        for (size_t i = 0; i < len;) {
+            size_t k = (i == 0 && len % rx.digits != 0 ? len % rx.digits : rx.digits);
+            limb_t chunk = 0, scale = 1;
+            for (size_t j = 0; j < k; j++) {
+                chunk = chunk * rx.base + static_cast<limb_t>(limbs::digit_value(s[i + j], rx.base));
+                scale *= rx.base;
+            }
+            i += k;
+            limb_t carry = mul_1(r, r, n, scale);
+            carry += add_1(r, r, n, chunk);
+            if (carry != 0)
+                r[n++] = carry;
+        }
+        return n;
+    }
+
+    // hi * big_base^(2^i) + lo, where lo takes the largest digits * 2^i digits that leave hi nonempty
+    size_t set_str_dc(limb_t *r, char const *s, size_t len, radix const &rx) {
+        if (len < SET_STR_DC_THRESHOLD * rx.digits)
+            return set_str_basecase(r, s, len, rx);
+        size_t i = 0;
+        while (power_at(rx, i + 1).digits < len)
+            i++;
+        radix_power const &pw = power_at(rx, i);
+        size_t pn = pw.p.size(), hi_len = len - pw.digits;
+        std::vector<limb_t> hi(set_str_size(hi_len, rx.base)), lo(set_str_size(pw.digits, rx.base));
+        size_t hn = set_str_dc(hi.data(), s, hi_len, rx);
+        size_t ln = set_str_dc(lo.data(), s + hi_len, pw.digits, rx);
+        if (hn == 0) {
+            std::copy(lo.begin(), lo.begin() + ln, r);
+            return ln;
+        }
+        if (hn > pn) {
+            mul(r, hi.data(), hn, pw.p.data(), pn);
+        } else {
+            mul(r, pw.p.data(), pn, hi.data(), hn);
+        }
+        size_t rn = hn + pn;
+        if (ln != 0)
+            add(r, r, rn, lo.data(), ln);
+        return normalized_size(r, rn);
+    }
+
+    // packs the digits from the least significant end, LIMB_BITS bits per limb
+    size_t set_str_pow2(limb_t *r, char const *s, size_t len, unsigned base) {
+        unsigned const bits = floor_log2(base);
+        size_t n = 0;
+        dlimb_t acc = 0;
+        unsigned acc_bits = 0;
+        for (size_t i = len; i-- > 0;) {
+            acc |= static_cast<dlimb_t>(limbs::digit_value(s[i], base)) << acc_bits;
+            acc_bits += bits;
+            if (acc_bits >= LIMB_BITS) {
+                r[n++] = static_cast<limb_t>(acc);
+                acc >>= LIMB_BITS;
+                acc_bits -= LIMB_BITS;
+            }
+        }
+        if (acc_bits > 0)
+            r[n++] = static_cast<limb_t>(acc);
+        return normalized_size(r, n);
+    }
+}
+
+int limbs::digit_value(char c, unsigned base) {
+    int v = -1;
+    if (c >= '0' && c <= '9') {
+        v = c - '0';
+    } else if (c >= 'A' && c <= 'Z') {
+        v = c - 'A' + 10;
+    } else if (c >= 'a' && c <= 'z') {
+        v = c - 'a' + (base > 36 ? 36 : 10);
+    }
+    return (v < static_cast<int>(base) ? v : -1);
+}
+
+size_t limbs::get_str_size(size_t n, unsigned base) {
+    return LIMB_BITS * n / floor_log2(base) + 1;
+}
+
+size_t limbs::get_str(char *s, limb_t const *a, size_t n, unsigned base) {
+    n = normalized_size(a, n);
+    if (n == 0) {
+        s[0] = '0';
+        return 1;
+    }
+    if (is_pow2_base(base))
+        return get_str_pow2(s, a, n, floor_log2(base));
+    radix const rx = radix_for(base);
+    // smallest i with a < big_base^(2^i)
+    size_t i = 0;
+    while (power_at(rx, i).p.size() <= n)
+        i++;
+    return static_cast<size_t>(get_str_dc(s, 0, a, n, i, rx) - s);
+}
+
+size_t limbs::set_str_size(size_t len, unsigned base) {
+    // every chunk of radix digits fits in a limb
+    unsigned const digits = radix_for(base).digits;
+    return (len + digits - 1) / digits + 1;
+}
+
+size_t limbs::set_str(limb_t *r, char const *s, size_t len, unsigned base) {
+    if (is_pow2_base(base))
+        return set_str_pow2(r, s, len, base);
+    return set_str_dc(r, s, len, radix_for(base));
+}
@@ -0,0 +1,128 @@
+#ifndef BIG_INTEGER_LIMBS_H
+#define BIG_INTEGER_LIMBS_H
+
+#include "limb.h"
+#include <cstddef>
+
+// Kernels over little-endian magnitudes stored as raw limb spans. They work on any caller-owned memory
+// (limb_t is uint32_t unless built with BIG_INTEGER_LIMB64); big_integer is a thin signed layer on top.
+// Results go to r (q for quotients) and the carry, borrow or shifted-out bits are returned.
+// Unless noted otherwise r may coincide with an operand but must not partially overlap one.
+namespace limbs {
+
+    // r[0, n) = a + b, a - b
+    limb_t add_n(limb_t *r, limb_t const *a, limb_t const *b, size_t n);
+
+    limb_t sub_n(limb_t *r, limb_t const *a, limb_t const *b, size_t n);
+
+    // an >= bn
+    limb_t add(limb_t *r, limb_t const *a, size_t an, limb_t const *b, size_t bn);
+
+    // an >= bn
+    limb_t sub(limb_t *r, limb_t const *a, size_t an, limb_t const *b, size_t bn);
+
+    // r[0, n) = a + b, a - b for a single limb b
+    limb_t add_1(limb_t *r, limb_t const *a, size_t n, limb_t b);
+
+    limb_t sub_1(limb_t *r, limb_t const *a, size_t n, limb_t b);
+
+    // r[0, n) = a * b, r[0, n) += a * b, r[0, n) -= a * b
+    limb_t mul_1(limb_t *r, limb_t const *a, size_t n, limb_t b);
+
+    limb_t addmul_1(limb_t *r, limb_t const *a, size_t n, limb_t b);
+
+    limb_t submul_1(limb_t *r, limb_t const *a, size_t n, limb_t b);
+
+    // shifts by 0 <= cnt < LIMB_BITS bits, returns the bits shifted out; lshift also allows r above a,
+    // rshift r below a
+    limb_t lshift(limb_t *r, limb_t const *a, size_t n, unsigned cnt);
+
+    limb_t rshift(limb_t *r, limb_t const *a, size_t n, unsigned cnt);
+
+    // r[0, n) = a & b, a | b, a ^ b; r may be a or b
+    void and_n(limb_t *r, limb_t const *a, limb_t const *b, size_t n);
+
+    void ior_n(limb_t *r, limb_t const *a, limb_t const *b, size_t n);
+
+    void xor_n(limb_t *r, limb_t const *a, limb_t const *b, size_t n);
+
+    // r[0, n) = ~a
+    void com(limb_t *r, limb_t const *a, size_t n);
+
+    // sign of a - b
+    int cmp(limb_t const *a, limb_t const *b, size_t n);
+
+    // n without the high zero limbs
+    size_t normalized_size(limb_t const *a, size_t n);
+
+    // r[0, an + bn) = a * b, an >= bn >= 1, r must not overlap the operands
+    void mul(limb_t *r, limb_t const *a, size_t an, limb_t const *b, size_t bn);
+
+    // r[0, 2n) = a * b, no overlap either
+    void mul_n(limb_t *r, limb_t const *a, limb_t const *b, size_t n);
+
+    // r[0, 2n) = a * a
+    void sqr(limb_t *r, limb_t const *a, size_t n);
+
+    void mul_basecase(limb_t *r, limb_t const *a, size_t an, limb_t const *b, size_t bn);
+
+    void sqr_basecase(limb_t *r, limb_t const *a, size_t n);
+
+    // returns a % b, q[0, n) = a / b
+    limb_t divrem_1(limb_t *q, limb_t const *a, size_t n, limb_t b);
+
+    // q[0, an - bn + 1) = a / b, r[0, bn) = a % b; an >= bn >= 1, b[bn - 1] != 0, q and r overlap nothing
+    void divrem(limb_t *q, limb_t *r, limb_t const *a, size_t an, limb_t const *b, size_t bn);
+
+    // Knuth's algorithm D for a normalized b (top bit set) and a[an - bn, an) < b:
+    // q[0, an - bn) = a / b, the remainder replaces a[0, bn) and the rest of a is zeroed
+    void div_basecase(limb_t *q, limb_t *a, size_t an, limb_t const *b, size_t bn);
+
+    // value of a digit character in base, or -1 if it is not one. Up to base 36 letters are case-insensitive;
+    // above that A-Z are 10-35 and a-z are 36-61
+    int digit_value(char c, unsigned base);
+
+    // string conversions take any base from 2 to MAX_BASE; letters print in lower case up to base 36
+
+    // upper bound on the digits of an n-limb number
+    size_t get_str_size(size_t n, unsigned base = 10);
+
+    // writes the digits of a[0, n) to s (no terminator), returns their count
+    size_t get_str(char *s, limb_t const *a, size_t n, unsigned base = 10);
+
+    // limbs that set_str may write for len digits
+    size_t set_str_size(size_t len, unsigned base = 10);
+
+    // parses the valid digits s[0, len) into r[0, set_str_size(len, base)), returns the normalized size
+    size_t set_str(limb_t *r, char const *s, size_t len, unsigned base = 10);
+
+    // the kernel set bound for this CPU at startup: "generic", or "x86-64" followed by the extensions in use
+    // ("bmi2 adx", "avx2" or "avx512")
+    char const *kernel_variant();
+
+    enum class mul_tier {
+        schoolbook, karatsuba, toom3, toom4, ntt
+    };
+
+    // algorithm that mul() uses at the top level for an an x bn limb product
+    mul_tier mul_tier_for(size_t an, size_t bn);
+
+    mul_tier sqr_tier_for(size_t n);
+
+    size_t const KARATSUBA_THRESHOLD = 32;
+    size_t const SQR_KARATSUBA_THRESHOLD = 48;
+    size_t const TOOM3_THRESHOLD = 120;
+    size_t const TOOM4_THRESHOLD = 400;
+    size_t const NTT_THRESHOLD = 6000;
+    size_t const BZ_THRESHOLD = 160;
+    size_t const NEWTON_THRESHOLD = 30000;
+    // precision below which reciprocal() falls back to a plain division
+    size_t const RECIPROCAL_THRESHOLD = 5000;
+    size_t const GET_STR_DC_THRESHOLD = 40;
+    size_t const SET_STR_DC_THRESHOLD = 40;
+    unsigned const MAX_BASE = 62;
+    // longest product (in limbs) that fits into a single three-prime transform of 32-bit pieces
+    size_t const NTT_MAX_SIZE = (LIMB_BITS == 32 ? size_t(1) << 23u : (size_t(1) << 22u) - 1);
+}
+
+#endif //BIG_INTEGER_LIMBS_H
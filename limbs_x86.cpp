@@ -0,0 +1,333 @@
+#include "limbs_x86.h"
+
+#ifdef BIG_INTEGER_X86
+
+#include <cpuid.h>
+#include <cstring>
+#include <x86intrin.h>
+
+namespace {
+    typedef unsigned long long word;
+
+    size_t const PER_WORD = 64 / LIMB_BITS;
+    // limbs per unrolled block of four words
+    size_t const BLOCK = 4 * PER_WORD;
+
+    inline word load(limb_t const *p) {
+        word w;
+        std::memcpy(&w, p, sizeof(w));
+        return w;
+    }
+
+    inline void store(limb_t *p, word w) {
+        std::memcpy(p, &w, sizeof(w));
+    }
+
+    // one word of a plain product: lo:t = a * b, r = lo + hi + CF
+#define MUL_STEP(k) \
+        "mulx " #k "(%[a]), %[lo], %[t]\n\t" \
+        "adcx %[hi], %[lo]\n\t" \
+        "mov %[lo], " #k "(%[r])\n\t" \
+        "mov %[t], %[hi]\n\t"
+
+    // one word of the ADCX / ADOX chains: lo:t = a * b, lo += hi + OF, then r += lo + CF
+#define ADDMUL_STEP(k) \
+        "mulx " #k "(%[a]), %[lo], %[t]\n\t" \
+        "adox %[hi], %[lo]\n\t" \
+        "adcx " #k "(%[r]), %[lo]\n\t" \
+        "mov %[lo], " #k "(%[r])\n\t" \
+        "mov %[t], %[hi]\n\t"
+
+    // r - s - borrow is r + ~s + (1 - borrow), so CF carries the negated borrow
+#define SUBMUL_STEP(k) \
+        "mulx " #k "(%[a]), %[lo], %[t]\n\t" \
+        "adox %[hi], %[lo]\n\t" \
+        "not %[lo]\n\t" \
+        "adcx " #k "(%[r]), %[lo]\n\t" \
+        "mov %[lo], " #k "(%[r])\n\t" \
+        "mov %[t], %[hi]\n\t"
+
+    struct and_op {
+        static limb_t apply(limb_t x, limb_t y) { return x & y; }
+
+        __attribute__((target("avx2"))) static __m256i apply(__m256i x, __m256i y) { return _mm256_and_si256(x, y); }
+
+        __attribute__((target("avx512f"))) static __m512i apply(__m512i x, __m512i y) { return _mm512_and_si512(x, y); }
+    };
+
+    struct ior_op {
+        static limb_t apply(limb_t x, limb_t y) { return x | y; }
+
+        __attribute__((target("avx2"))) static __m256i apply(__m256i x, __m256i y) { return _mm256_or_si256(x, y); }
+
+        __attribute__((target("avx512f"))) static __m512i apply(__m512i x, __m512i y) { return _mm512_or_si512(x, y); }
+    };
+
+    struct xor_op {
+        static limb_t apply(limb_t x, limb_t y) { return x ^ y; }
+
+        __attribute__((target("avx2"))) static __m256i apply(__m256i x, __m256i y) { return _mm256_xor_si256(x, y); }
+
+        __attribute__((target("avx512f"))) static __m512i apply(__m512i x, __m512i y) { return _mm512_xor_si512(x, y); }
+    };
+
+    // two vectors per iteration, then single limbs; unaligned loads, r may be a or b
+    template<class Op>
+    __attribute__((target("avx2"))) void bitwise_avx2(limb_t *r, limb_t const *a, limb_t const *b, size_t n) {
+        size_t const step = sizeof(__m256i) / sizeof(limb_t);
+        size_t i = 0;
+        for (; i + 2 * step <= n; i += 2 * step) {
+            __m256i x0 = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(a + i));
+            __m256i x1 = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(a + i + step));
+            __m256i y0 = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(b + i));
+            __m256i y1 = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(b + i + step));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(r + i), Op::apply(x0, y0));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(r + i + step), Op::apply(x1, y1));
+        }
+        for (; i < n; i++)
+            r[i] = Op::apply(a[i], b[i]);
+    }
+
+    template<class Op>
+    __attribute__((target("avx512f"))) void bitwise_avx512(limb_t *r, limb_t const *a, limb_t const *b, size_t n) {
+        size_t const step = sizeof(__m512i) / sizeof(limb_t);
+        size_t i = 0;
+        for (; i + 2 * step <= n; i += 2 * step) {
+            __m512i x0 = _mm512_loadu_si512(a + i);
+            __m512i x1 = _mm512_loadu_si512(a + i + step);
+            __m512i y0 = _mm512_loadu_si512(b + i);
+            __m512i y1 = _mm512_loadu_si512(b + i + step);
+            _mm512_storeu_si512(r + i, Op::apply(x0, y0));
+            _mm512_storeu_si512(r + i + step, Op::apply(x1, y1));
+        }
+        for (; i < n; i++)
+            r[i] = Op::apply(a[i], b[i]);
+    }
+
+    // xgetbv bits for the SSE / AVX state and the three AVX-512 state components
+    unsigned const XCR0_AVX = 0x6, XCR0_AVX512 = 0xe6;
+
+    unsigned long long xgetbv() {
+        unsigned eax, edx;
+        __asm__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+        return (static_cast<unsigned long long>(edx) << 32u) | eax;
+    }
+}
+
+limb_t limbs::x86::add_n(limb_t *r, limb_t const *a, limb_t const *b, size_t n) {
+    unsigned char c = 0;
+    size_t i = 0;
+    for (; i + BLOCK <= n; i += BLOCK) {
+        word s0, s1, s2, s3;
+        c = _addcarry_u64(c, load(a + i), load(b + i), &s0);
+        c = _addcarry_u64(c, load(a + i + PER_WORD), load(b + i + PER_WORD), &s1);
+        c = _addcarry_u64(c, load(a + i + 2 * PER_WORD), load(b + i + 2 * PER_WORD), &s2);
+        c = _addcarry_u64(c, load(a + i + 3 * PER_WORD), load(b + i + 3 * PER_WORD), &s3);
+        store(r + i, s0);
+        store(r + i + PER_WORD, s1);
+        store(r + i + 2 * PER_WORD, s2);
+        store(r + i + 3 * PER_WORD, s3);
+    }
+    dlimb_t carry = c;
+    for (; i < n; i++) {
+        carry += static_cast<dlimb_t>(a[i]) + b[i];
+        r[i] = static_cast<limb_t>(carry);
+        carry >>= LIMB_BITS;
+    }
+    return static_cast<limb_t>(carry);
+}
+
+limb_t limbs::x86::sub_n(limb_t *r, limb_t const *a, limb_t const *b, size_t n) {
+    unsigned char c = 0;
+    size_t i = 0;
+    for (; i + BLOCK <= n; i += BLOCK) {
+        word s0, s1, s2, s3;
+        c = _subborrow_u64(c, load(a + i), load(b + i), &s0);
+        c = _subborrow_u64(c, load(a + i + PER_WORD), load(b + i + PER_WORD), &s1);
+        c = _subborrow_u64(c, load(a + i + 2 * PER_WORD), load(b + i + 2 * PER_WORD), &s2);
+        c = _subborrow_u64(c, load(a + i + 3 * PER_WORD), load(b + i + 3 * PER_WORD), &s3);
+        store(r + i, s0);
+        store(r + i + PER_WORD, s1);
+        store(r + i + 2 * PER_WORD, s2);
+        store(r + i + 3 * PER_WORD, s3);
+    }
+    limb_t borrow = c;
+    for (; i < n; i++) {
+        dlimb_t tmp = static_cast<dlimb_t>(a[i]) - b[i] - borrow;
+        r[i] = static_cast<limb_t>(tmp);
+        borrow = static_cast<limb_t>(tmp >> (2 * LIMB_BITS - 1));
+    }
+    return borrow;
+}
+
+limb_t limbs::x86::mul_1(limb_t *r, limb_t const *a, size_t n, limb_t b) {
+    word hi = 0;
+    size_t blocks = n / BLOCK;
+    if (blocks > 0) {
+        word lo, t;
+        __asm__(
+        "xor %k[lo], %k[lo]\n\t"
+        "1:\n\t"
+        MUL_STEP(0)
+        MUL_STEP(8)
+        MUL_STEP(16)
+        MUL_STEP(24)
+        "lea 32(%[a]), %[a]\n\t"
+        "lea 32(%[r]), %[r]\n\t"
+        "lea -1(%[cnt]), %[cnt]\n\t"
+        "jrcxz 2f\n\t"
+        "jmp 1b\n\t"
+        "2:\n\t"
+        "mov $0, %k[lo]\n\t"
+        "adcx %[lo], %[hi]\n\t"
+        : [r] "+r"(r), [a] "+r"(a), [cnt] "+c"(blocks), [hi] "+r"(hi), [lo] "=&r"(lo), [t] "=&r"(t)
+        : "d"(static_cast<word>(b))
+        : "cc", "memory");
+    }
+    limb_t carry = static_cast<limb_t>(hi);
+    for (size_t i = 0; i < n % BLOCK; i++) {
+        dlimb_t tmp = static_cast<dlimb_t>(a[i]) * b + carry;
+        r[i] = static_cast<limb_t>(tmp);
+        carry = static_cast<limb_t>(tmp >> LIMB_BITS);
+    }
+    return carry;
+}
+
+limb_t limbs::x86::addmul_1(limb_t *r, limb_t const *a, size_t n, limb_t b) {
+    // the word loop leaves a carry below b, so it fits a limb even when b is a 32-bit limb
+    word hi = 0;
+    size_t blocks = n / BLOCK;
+    if (blocks > 0) {
+        word lo, t;
+        __asm__(
+        "xor %k[lo], %k[lo]\n\t"
+        "1:\n\t"
+        ADDMUL_STEP(0)
+        ADDMUL_STEP(8)
+        ADDMUL_STEP(16)
+        ADDMUL_STEP(24)
+        "lea 32(%[a]), %[a]\n\t"
+        "lea 32(%[r]), %[r]\n\t"
+        "lea -1(%[cnt]), %[cnt]\n\t"
+        "jrcxz 2f\n\t"
+        "jmp 1b\n\t"
+        "2:\n\t"
+        "mov $0, %k[lo]\n\t"
+        "adox %[lo], %[hi]\n\t"
+        "adcx %[lo], %[hi]\n\t"
+        : [r] "+r"(r), [a] "+r"(a), [cnt] "+c"(blocks), [hi] "+r"(hi), [lo] "=&r"(lo), [t] "=&r"(t)
+        : "d"(static_cast<word>(b))
+        : "cc", "memory");
+    }
+    limb_t carry = static_cast<limb_t>(hi);
+    for (size_t i = 0; i < n % BLOCK; i++) {
+        dlimb_t tmp = static_cast<dlimb_t>(a[i]) * b + r[i] + carry;
+        r[i] = static_cast<limb_t>(tmp);
+        carry = static_cast<limb_t>(tmp >> LIMB_BITS);
+    }
+    return carry;
+}
+
+limb_t limbs::x86::submul_1(limb_t *r, limb_t const *a, size_t n, limb_t b) {
+    word hi = 0;
+    size_t blocks = n / BLOCK;
+    if (blocks > 0) {
+        word lo, t;
+        __asm__(
+        "xor %k[lo], %k[lo]\n\t"
+        "stc\n\t"
+        "1:\n\t"
+        SUBMUL_STEP(0)
+        SUBMUL_STEP(8)
+        SUBMUL_STEP(16)
+        SUBMUL_STEP(24)
+        "lea 32(%[a]), %[a]\n\t"
+        "lea 32(%[r]), %[r]\n\t"
+        "lea -1(%[cnt]), %[cnt]\n\t"
+        "jrcxz 2f\n\t"
+        "jmp 1b\n\t"
+        "2:\n\t"
+        "mov $0, %k[lo]\n\t"
+        "adox %[lo], %[hi]\n\t"
+        "cmc\n\t"
+        "adcx %[lo], %[hi]\n\t"
+        : [r] "+r"(r), [a] "+r"(a), [cnt] "+c"(blocks), [hi] "+r"(hi), [lo] "=&r"(lo), [t] "=&r"(t)
+        : "d"(static_cast<word>(b))
+        : "cc", "memory");
+    }
+    limb_t borrow = static_cast<limb_t>(hi);
+    for (size_t i = 0; i < n % BLOCK; i++) {
+        dlimb_t prod = static_cast<dlimb_t>(a[i]) * b + borrow;
+        limb_t lo = static_cast<limb_t>(prod);
+        borrow = static_cast<limb_t>(prod >> LIMB_BITS) + (r[i] < lo);
+        r[i] -= lo;
+    }
+    return borrow;
+}
+
+void limbs::x86::and_n_avx2(limb_t *r, limb_t const *a, limb_t const *b, size_t n) {
+    bitwise_avx2<and_op>(r, a, b, n);
+}
+
+void limbs::x86::ior_n_avx2(limb_t *r, limb_t const *a, limb_t const *b, size_t n) {
+    bitwise_avx2<ior_op>(r, a, b, n);
+}
+
+void limbs::x86::xor_n_avx2(limb_t *r, limb_t const *a, limb_t const *b, size_t n) {
+    bitwise_avx2<xor_op>(r, a, b, n);
+}
+
+__attribute__((target("avx2"))) void limbs::x86::com_avx2(limb_t *r, limb_t const *a, size_t n) {
+    size_t const step = sizeof(__m256i) / sizeof(limb_t);
+    __m256i const ones = _mm256_set1_epi32(-1);
+    size_t i = 0;
+    for (; i + step <= n; i += step) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(a + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(r + i), _mm256_xor_si256(x, ones));
+    }
+    for (; i < n; i++)
+        r[i] = ~a[i];
+}
+
+void limbs::x86::and_n_avx512(limb_t *r, limb_t const *a, limb_t const *b, size_t n) {
+    bitwise_avx512<and_op>(r, a, b, n);
+}
+
+void limbs::x86::ior_n_avx512(limb_t *r, limb_t const *a, limb_t const *b, size_t n) {
+    bitwise_avx512<ior_op>(r, a, b, n);
+}
+
+void limbs::x86::xor_n_avx512(limb_t *r, limb_t const *a, limb_t const *b, size_t n) {
+    bitwise_avx512<xor_op>(r, a, b, n);
+}
+
+__attribute__((target("avx512f"))) void limbs::x86::com_avx512(limb_t *r, limb_t const *a, size_t n) {
+    size_t const step = sizeof(__m512i) / sizeof(limb_t);
+    __m512i const ones = _mm512_set1_epi32(-1);
+    size_t i = 0;
+    for (; i + step <= n; i += step)
+        _mm512_storeu_si512(r + i, _mm512_xor_si512(_mm512_loadu_si512(a + i), ones));
+    for (; i < n; i++)
+        r[i] = ~a[i];
+}
+
+limbs::x86::cpu_features limbs::x86::probe() {
+    cpu_features f;
+    unsigned eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+        return f;
+    unsigned long long const xcr0 = ((ecx & bit_OSXSAVE) != 0 ? xgetbv() : 0);
+    if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+        f.bmi2 = (ebx & bit_BMI2) != 0;
+        f.adx = (ebx & bit_ADX) != 0;
+        f.avx2 = (ebx & bit_AVX2) != 0 && (xcr0 & XCR0_AVX) == XCR0_AVX;
+        f.avx512 = (ebx & bit_AVX512F) != 0 && (xcr0 & XCR0_AVX512) == XCR0_AVX512;
+    }
+    return f;
+}
+
+#undef MUL_STEP
+#undef ADDMUL_STEP
+#undef SUBMUL_STEP
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef BIG_INTEGER_LIMBS_X86_H
+#define BIG_INTEGER_LIMBS_X86_H
+
+#include "limb.h"
+#include <cstddef>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define BIG_INTEGER_X86
+
+// x86-64 versions of the core kernels. They run over 64-bit machine words, that is two 32-bit limbs or one
+// 64-bit limb at a time, and finish odd limbs with plain C++. Same contracts as their limbs:: counterparts.
+namespace limbs {
+    namespace x86 {
+
+        // ADC chains, available on every x86-64
+        limb_t add_n(limb_t *r, limb_t const *a, limb_t const *b, size_t n);
+
+        limb_t sub_n(limb_t *r, limb_t const *a, limb_t const *b, size_t n);
+
+        // MULX with ADCX / ADOX carry chains, need BMI2 and ADX
+        limb_t mul_1(limb_t *r, limb_t const *a, size_t n, limb_t b);
+
+        limb_t addmul_1(limb_t *r, limb_t const *a, size_t n, limb_t b);
+
+        limb_t submul_1(limb_t *r, limb_t const *a, size_t n, limb_t b);
+
+        // r[0, n) = a & b, a | b, a ^ b and ~a with 256-bit vectors, need AVX2
+        void and_n_avx2(limb_t *r, limb_t const *a, limb_t const *b, size_t n);
+
+        void ior_n_avx2(limb_t *r, limb_t const *a, limb_t const *b, size_t n);
+
+        void xor_n_avx2(limb_t *r, limb_t const *a, limb_t const *b, size_t n);
+
+        void com_avx2(limb_t *r, limb_t const *a, size_t n);
+
+        // the same with 512-bit vectors, need AVX-512F
+        void and_n_avx512(limb_t *r, limb_t const *a, limb_t const *b, size_t n);
+
+        void ior_n_avx512(limb_t *r, limb_t const *a, limb_t const *b, size_t n);
+
+        void xor_n_avx512(limb_t *r, limb_t const *a, limb_t const *b, size_t n);
+
+        void com_avx512(limb_t *r, limb_t const *a, size_t n);
+
+        struct cpu_features {
+            bool bmi2 = false;
+            bool adx = false;
+            // the vector extensions count only when the OS saves their registers
+            bool avx2 = false;
+            bool avx512 = false;
+        };
+
+        // features of the running CPU, read with CPUID
+        cpu_features probe();
+    }
+}
+
+#endif
+
+#endif //BIG_INTEGER_LIMBS_X86_H
@@ -4,27 +4,68 @@
 
 #include <cstring>
 #include <algorithm>
+#include <new>
 #include <assert.h>
 #include "my_vector.h"
 
+my_vector::dynamic_data *my_vector::allocate(size_t capacity) {
+    void *p = ::operator new(sizeof(dynamic_data) + capacity * sizeof(limb_t));
+    return new(p) dynamic_data(capacity);
+}
+
+#ifdef BIG_INTEGER_SINGLE_THREADED
+
+void my_vector::retain(dynamic_data *d) {
+    d->refs++;
+}
+
+void my_vector::release(dynamic_data *d) {
+    if (--d->refs == 0) {
+        d->~dynamic_data();
+        ::operator delete(d);
+    }
+}
+
+bool my_vector::unique(dynamic_data *d) {
+    return d->refs == 1;
+}
+
+#else
+
+void my_vector::retain(dynamic_data *d) {
+    d->refs.fetch_add(1, std::memory_order_relaxed);
+}
+
+void my_vector::release(dynamic_data *d) {
+    if (d->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        d->~dynamic_data();
+        ::operator delete(d);
+    }
+}
+
+bool my_vector::unique(dynamic_data *d) {
+    return d->refs.load(std::memory_order_acquire) == 1;
+}
+
+#endif
+
 my_vector::my_vector() : _size(0), is_small(1) {}
 
 my_vector::my_vector(size_t s) : _size(s) {
     if (s > _SIZE) {
-        new(&big) dynamic_data(new uint32_t[2 * s], 2 * s);
+        big = allocate(2 * s);
         is_small = false;
     } else is_small = true;
 }
 
-my_vector::my_vector(size_t s, uint32_t _n) : _size(s) {
+my_vector::my_vector(size_t s, limb_t _n) : _size(s) {
     if (s > _SIZE) {
-        auto tmp = new uint32_t[2 * s];
-        std::memset(tmp, _n, s * sizeof(uint32_t));
-        new(&big) dynamic_data(tmp, 2 * s);
+        big = allocate(2 * s);
+        std::fill_n(big->limbs(), s, _n);
         is_small = false;
     } else {
         is_small = true;
-        std::memset(small, _n, s * sizeof(uint32_t));
+        std::fill_n(small, s, _n);
     }
 }
 
@@ -32,91 +73,109 @@ my_vector::my_vector(my_vector const &other) {
     _size = other._size;
     is_small = other.is_small;
     if (other.is_small) {
-        std::memcpy(small, other.small, _SIZE * sizeof(uint32_t));
+        std::memcpy(small, other.small, _SIZE * sizeof(limb_t));
     } else {
-        new(&big) dynamic_data(other.big);
+        big = other.big;
+        retain(big);
     }
 }
 
+my_vector::my_vector(my_vector &&other) noexcept : _size(other._size), is_small(other.is_small) {
+    if (is_small) {
+        std::memcpy(small, other.small, _SIZE * sizeof(limb_t));
+    } else {
+        big = other.big;
+        other.is_small = true;
+    }
+    other._size = 0;
+}
+
 size_t my_vector::size() const {
     return _size;
 }
 
 size_t my_vector::capacity() const {
-    return (is_small ? _SIZE : big.capacity);
+    return (is_small ? _SIZE : big->capacity);
 }
 
 void my_vector::resize(size_t _n) {
     ensure_capacity(_n);
-    uint32_t *ptr = (is_small ? small : big.data.get());
+    limb_t *ptr = (is_small ? small : big->limbs());
     for (; _size < _n; _size++)
         ptr[_size] = 0;
     _size = _n;
 }
 
-void my_vector::resize(size_t _n, uint32_t _a) {
+void my_vector::resize(size_t _n, limb_t _a) {
     ensure_capacity(_n);
-    uint32_t *ptr = (is_small ? small : big.data.get());
+    limb_t *ptr = (is_small ? small : big->limbs());
     for (; _size < _n; _size++)
         ptr[_size] = _a;
     _size = _n;
 }
 
-void my_vector::push_back(uint32_t _a) {
+void my_vector::reset(size_t _n) {
+    if (!is_small && !unique(big)) {
+        my_vector tmp(_n);
+        swap(tmp);
+        return;
+    }
+    _size = 0;
+    ensure_capacity(_n);
+    _size = _n;
+}
+
+void my_vector::push_back(limb_t _a) {
     resize(_size + 1, _a);
 }
 
-uint32_t my_vector::back() {
-    return (is_small ? small[_size - 1] : big.data[_size - 1]);
+limb_t my_vector::back() {
+    return (is_small ? small[_size - 1] : big->limbs()[_size - 1]);
 }
 
-void my_vector::assign(size_t _n, uint32_t _a) {
+void my_vector::assign(size_t _n, limb_t _a) {
     ensure_capacity(_n);
-    uint32_t *ptr = (is_small ? small : big.data.get());
+    limb_t *ptr = (is_small ? small : big->limbs());
     for (_size = 0; _size < _n; _size++)
         ptr[_size] = _a;
 }
 
-uint32_t &my_vector::operator[](size_t const &_n) {
+limb_t &my_vector::operator[](size_t const &_n) {
     assert(_n < _size);
     if (!is_small) {
-        if (!big.data.unique()) {
-            auto tmp = new uint32_t[capacity()];
-            memcpy(tmp, big.data.get(), _size * sizeof(uint32_t));
-            big.data.reset(tmp);
-        }
-        return big.data[_n];
+        unshare();
+        return big->limbs()[_n];
     }
     return small[_n];
 }
 
-const uint32_t &my_vector::operator[](size_t const &_n) const {
+const limb_t &my_vector::operator[](size_t const &_n) const {
     if (is_small)
         return small[_n];
-    return big.data[_n];
+    return big->limbs()[_n];
+}
+
+limb_t *my_vector::data() {
+    if (is_small)
+        return small;
+    unshare();
+    return big->limbs();
+}
+
+const limb_t *my_vector::data() const {
+    return (is_small ? small : big->limbs());
 }
 
 void my_vector::swap(my_vector &other) {
-    if (is_small) {
-        if (other.is_small) {
-            std::swap(small, other.small);
-        } else {
-            uint32_t tmp[_SIZE];
-            memcpy(tmp, small, _size * sizeof(uint32_t));
-            new(&big) dynamic_data(other.big);
-            other.big.~dynamic_data();
-            memcpy(other.small, tmp, _size * sizeof(uint32_t));
-        }
+    if (is_small && other.is_small) {
+        std::swap(small, other.small);
+    } else if (!is_small && !other.is_small) {
+        std::swap(big, other.big);
     } else {
-        if (other.is_small) {
-            uint32_t tmp[_SIZE];
-            memcpy(tmp, other.small, other._size * sizeof(uint32_t));
-            new(&other.big) dynamic_data(big);
-            big.~dynamic_data();
-            memcpy(small, tmp, other._size * sizeof(uint32_t));
-        } else {
-            std::swap(big, other.big);
-        }
+        my_vector &s = (is_small ? *this : other), &b = (is_small ? other : *this);
+        dynamic_data *d = b.big;
+        memcpy(b.small, s.small, _SIZE * sizeof(limb_t));
+        s.big = d;
     }
     std::swap(_size, other._size);
     std::swap(is_small, other.is_small);
@@ -128,43 +187,49 @@ my_vector &my_vector::operator=(my_vector const &other) {
     return *this;
 }
 
+my_vector &my_vector::operator=(my_vector &&other) noexcept {
+    my_vector tmp(std::move(other));
+    swap(tmp);
+    return *this;
+}
+
 my_vector::~my_vector() {
     if (!is_small)
-        big.~dynamic_data();
+        release(big);
 }
 
 void my_vector::ensure_capacity(size_t _n) {
     if (_n <= _SIZE) {
         if (!is_small) {
+            dynamic_data *d = big;
             is_small = true;
-            uint32_t tmp[_SIZE];
-            memcpy(tmp, big.data.get(), _n * sizeof(uint32_t));
-            big.~dynamic_data();
-            memcpy(small, tmp, _n * sizeof(uint32_t));
+            memcpy(small, d->limbs(), std::min(_size, _n) * sizeof(limb_t));
+            release(d);
         }
         return;
     }
-    if (_n > _SIZE) {
-        if (is_small) {
-            is_small = false;
-            auto tmp = new uint32_t[_n * 2 + 1];
-            memcpy(tmp, small, _size * sizeof(uint32_t));
-            new(&big) dynamic_data(tmp, _n * 2 + 1);
-            return;
-        }
+    if (is_small) {
+        dynamic_data *d = allocate(_n * 2 + 1);
+        memcpy(d->limbs(), small, _size * sizeof(limb_t));
+        big = d;
+        is_small = false;
+        return;
     }
     if ((capacity() <= _n) || (_n * 4 < capacity())) {
-        auto tmp = new uint32_t[_n * 2 + 1];
-        memcpy(tmp, big.data.get(), std::min(_size, _n) * sizeof(uint32_t));
-        big.~dynamic_data();
-        new(&big) dynamic_data(tmp, _n * 2 + 1);
+        dynamic_data *d = allocate(_n * 2 + 1);
+        memcpy(d->limbs(), big->limbs(), std::min(_size, _n) * sizeof(limb_t));
+        release(big);
+        big = d;
         return;
     }
-    if (!big.data.unique()) {
-        auto tmp = new uint32_t[capacity()];
-        memcpy(tmp, big.data.get(), _size * sizeof(uint32_t));
-        big.data.reset(tmp);
-    }
+    unshare();
 }
 
-
+void my_vector::unshare() {
+    if (!unique(big)) {
+        dynamic_data *d = allocate(big->capacity);
+        memcpy(d->limbs(), big->limbs(), _size * sizeof(limb_t));
+        release(big);
+        big = d;
+    }
+}
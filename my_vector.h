@@ -6,20 +6,24 @@
 #define BIG_INTEGER_MY_VECTOR_H
 
 
-#include <cstdint>
+#include "limb.h"
 #include <cstddef>
-#include <memory>
+#include <atomic>
 
 class my_vector {
 public:
 
     void swap(my_vector &other);
 
-    uint32_t &operator[](size_t const &_n);
+    limb_t &operator[](size_t const &_n);
 
-    const uint32_t &operator[](size_t const &_n) const;
+    const limb_t &operator[](size_t const &_n) const;
 
-    void push_back(uint32_t _a);
+    limb_t *data();
+
+    const limb_t *data() const;
+
+    void push_back(limb_t _a);
 
     size_t size() const;
 
@@ -27,43 +31,71 @@ public:
 
     my_vector(my_vector const &other);
 
+    // takes over the storage and leaves other empty
+    my_vector(my_vector &&other) noexcept;
+
     explicit my_vector(size_t s);
 
-    my_vector(size_t s, uint32_t _n);
+    my_vector(size_t s, limb_t _n);
 
     my_vector &operator=(my_vector const &other);
 
-    void assign(size_t _n, uint32_t _a);
+    my_vector &operator=(my_vector &&other) noexcept;
+
+    void assign(size_t _n, limb_t _a);
 
     void resize(size_t _n);
 
-    void resize(size_t _n, uint32_t _a);
+    void resize(size_t _n, limb_t _a);
+
+    // _n limbs of unspecified value, in the current buffer unless it is shared or too small
+    void reset(size_t _n);
 
-    uint32_t back();
+    limb_t back();
 
     size_t capacity() const;
 
     ~my_vector();
 
 private:
-    void ensure_capacity(size_t _n);
-
-    static const uint32_t _SIZE = 4;
-    size_t _size;
+#ifdef BIG_INTEGER_SINGLE_THREADED
+    // copies of a number never meet on another thread, so a plain counter will do
+    typedef size_t ref_count;
+#else
+    typedef std::atomic<size_t> ref_count;
+#endif
+
+    // heap storage: this header followed by the limbs, in one allocation that copies share until one of them writes
     struct dynamic_data {
-        std::shared_ptr<uint32_t[]> data;
+        ref_count refs;
         size_t capacity;
 
-        dynamic_data() = default;
-
-        dynamic_data(dynamic_data const &other) = default;
+        explicit dynamic_data(size_t c) : refs(1), capacity(c) {}
 
-        dynamic_data(uint32_t other[], size_t c) : data(other), capacity(c) {}
+        limb_t *limbs() {
+            return reinterpret_cast<limb_t *>(this + 1);
+        }
     };
 
+    static dynamic_data *allocate(size_t capacity);
+
+    static void retain(dynamic_data *d);
+
+    static void release(dynamic_data *d);
+
+    static bool unique(dynamic_data *d);
+
+    void ensure_capacity(size_t _n);
+
+    // copies the heap limbs when another vector holds them too
+    void unshare();
+
+    static const uint32_t _SIZE = 4;
+    size_t _size;
+
     union {
-        dynamic_data big;
-        uint32_t small[_SIZE];
+        dynamic_data *big;
+        limb_t small[_SIZE];
     };
 
     bool is_small;